@@ -0,0 +1,136 @@
+#include "Fix64Batch.h"
+#include "Fix64BatchKernels.h"
+
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace fix64_batch {
+namespace detail {
+
+const Kernels &ScalarKernels() {
+  static const Kernels kernels = {
+      Binary<AddOne>,     Binary<SubOne>,     Binary<MulOne>,         Binary<DivOne>,
+      Ternary<MulAddOne>, Binary<SafeAddOne>, Binary<SafeSubOne>,     Binary<SafeMulOne>,
+      Binary<SafeDivOne>, Ternary<SafeMulAddOne>, LessScalar, EqualScalar, SelectScalar, ScaleAddScalar,
+  };
+  return kernels;
+}
+
+} // namespace detail
+
+namespace {
+
+using detail::Kernels;
+
+bool CpuSupports(Isa isa) {
+  if (isa == Isa::kScalar)
+    return true;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (isa == Isa::kAvx2)
+    return __builtin_cpu_supports("avx2");
+  return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("avx512vl");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 1);
+  // OSXSAVE，操作系统保存 AVX 寄存器
+  if (!(info[2] & (1 << 27)))
+    return false;
+  unsigned long long xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+  if (isa == Isa::kAvx2)
+    return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5));
+  return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) && (info[1] & (1 << 30)) && (info[1] & (1u << 31));
+#else
+  return false;
+#endif
+}
+
+const Kernels *KernelsFor(Isa isa) {
+  if (!CpuSupports(isa))
+    return nullptr;
+  switch (isa) {
+  case Isa::kAvx512:
+    return detail::Avx512Kernels();
+  case Isa::kAvx2:
+    return detail::Avx2Kernels();
+  case Isa::kScalar:
+    break;
+  }
+  return &detail::ScalarKernels();
+}
+
+// SetIsa 可能和批量运算并发，所以是原子的；每次运算只读一次 kernels，
+// release / acquire 保证读到的那组 kernel 已经初始化
+struct Active {
+  Active() {
+    for (Isa candidate : {Isa::kAvx512, Isa::kAvx2, Isa::kScalar}) {
+      if (const Kernels *k = KernelsFor(candidate)) {
+        isa.store(candidate, std::memory_order_relaxed);
+        kernels.store(k, std::memory_order_release);
+        break;
+      }
+    }
+  }
+  std::atomic<Isa> isa{Isa::kScalar};
+  std::atomic<const Kernels *> kernels{nullptr};
+};
+
+Active &Current() {
+  static Active active;
+  return active;
+}
+
+const Kernels &K() { return *Current().kernels.load(std::memory_order_acquire); }
+
+} // namespace
+
+Isa ActiveIsa() { return Current().isa.load(std::memory_order_relaxed); }
+
+bool SetIsa(Isa isa) {
+  const Kernels *k = KernelsFor(isa);
+  if (!k)
+    return false;
+  Current().isa.store(isa, std::memory_order_relaxed);
+  Current().kernels.store(k, std::memory_order_release);
+  return true;
+}
+
+const char *IsaName(Isa isa) {
+  switch (isa) {
+  case Isa::kAvx512:
+    return "avx512";
+  case Isa::kAvx2:
+    return "avx2";
+  case Isa::kScalar:
+    break;
+  }
+  return "scalar";
+}
+
+void Add(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().add(a, b, out, n); }
+void Sub(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().sub(a, b, out, n); }
+void Mul(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().mul(a, b, out, n); }
+void Div(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().div(a, b, out, n); }
+void MulAdd(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+  K().mulAdd(a, b, c, out, n);
+}
+void ScaleAdd(const int64_t *a, int64_t s, const int64_t *c, int64_t *out, size_t n) { K().scaleAdd(a, s, c, out, n); }
+void SafeAdd(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().safeAdd(a, b, out, n); }
+void SafeSub(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().safeSub(a, b, out, n); }
+void SafeMul(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().safeMul(a, b, out, n); }
+void SafeDiv(const int64_t *a, const int64_t *b, int64_t *out, size_t n) { K().safeDiv(a, b, out, n); }
+void SafeMulAdd(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+  K().safeMulAdd(a, b, c, out, n);
+}
+void Less(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) { K().less(a, b, mask, n); }
+void Equal(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) { K().equal(a, b, mask, n); }
+void Select(const uint8_t *mask, const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  K().select(mask, a, b, out, n);
+}
+
+} // namespace fix64_batch
@@ -0,0 +1,82 @@
+// 连续的 Fix64 / int64 原始值数组上的批量运算，每一步对很多值做同样运算的代码使用
+// 每个函数的结果和逐个使用 Fix64 的运算符（operator+ ... SafeDiv）逐位相同，
+// 所以帧同步的各端可以使用不同的实现
+//
+// 运行时选择一次实现：AVX-512 (F/BW/VL)、AVX2 或标量。没有 SIMD 整数除法，除法都是标量的
+// 参数是指针加个数：工程是 C++17，没有 std::span；vector 或者 SoA 的数组传 data() 和 size()
+// out 可以和某个输入是同一个数组，但不能部分重叠
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "Fix64.h"
+
+namespace fix64_batch {
+
+enum class Isa { kScalar, kAvx2, kAvx512 };
+
+// 正在使用的实现
+Isa ActiveIsa();
+// 测试和性能测试使用，cpu 不支持 isa 时返回 false；
+// 可以和批量运算并发调用，正在执行的运算用切换之前的实现做完
+bool SetIsa(Isa isa);
+const char *IsaName(Isa isa);
+
+// out = a op b，和运算符一样溢出时回绕
+void Add(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void Sub(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void Mul(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void Div(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+// out = a * b + c
+void MulAdd(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n);
+// out = a * s + c，所有元素的 s 相同，例如 position += velocity * dt
+void ScaleAdd(const int64_t *a, int64_t s, const int64_t *c, int64_t *out, size_t n);
+
+// 饱和运算，和 SafeAdd / SafeMinus / SafeMul / SafeDiv 相同
+void SafeAdd(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void SafeSub(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void SafeMul(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+void SafeDiv(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+// out = SafeAdd(SafeMul(a, b), c)
+void SafeMulAdd(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n);
+
+// mask[i] = a[i] < b[i] / a[i] == b[i]，取值 0 或 1
+void Less(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n);
+void Equal(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n);
+// out[i] = mask[i] ? a[i] : b[i]
+void Select(const uint8_t *mask, const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+
+// Fix64 的重载，Fix64 数组就是它的原始值数组
+static_assert(sizeof(Fix64) == sizeof(int64_t) && std::is_standard_layout<Fix64>::value,
+              "Fix64 must be a plain int64");
+
+inline const int64_t *Raw(const Fix64 *p) { return reinterpret_cast<const int64_t *>(p); }
+inline int64_t *Raw(Fix64 *p) { return reinterpret_cast<int64_t *>(p); }
+
+inline void Add(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { Add(Raw(a), Raw(b), Raw(out), n); }
+inline void Sub(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { Sub(Raw(a), Raw(b), Raw(out), n); }
+inline void Mul(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { Mul(Raw(a), Raw(b), Raw(out), n); }
+inline void Div(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { Div(Raw(a), Raw(b), Raw(out), n); }
+inline void MulAdd(const Fix64 *a, const Fix64 *b, const Fix64 *c, Fix64 *out, size_t n) {
+  MulAdd(Raw(a), Raw(b), Raw(c), Raw(out), n);
+}
+inline void ScaleAdd(const Fix64 *a, const Fix64 &s, const Fix64 *c, Fix64 *out, size_t n) {
+  ScaleAdd(Raw(a), s.GetRaw(), Raw(c), Raw(out), n);
+}
+inline void SafeAdd(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { SafeAdd(Raw(a), Raw(b), Raw(out), n); }
+inline void SafeSub(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { SafeSub(Raw(a), Raw(b), Raw(out), n); }
+inline void SafeMul(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { SafeMul(Raw(a), Raw(b), Raw(out), n); }
+inline void SafeDiv(const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) { SafeDiv(Raw(a), Raw(b), Raw(out), n); }
+inline void SafeMulAdd(const Fix64 *a, const Fix64 *b, const Fix64 *c, Fix64 *out, size_t n) {
+  SafeMulAdd(Raw(a), Raw(b), Raw(c), Raw(out), n);
+}
+inline void Less(const Fix64 *a, const Fix64 *b, uint8_t *mask, size_t n) { Less(Raw(a), Raw(b), mask, n); }
+inline void Equal(const Fix64 *a, const Fix64 *b, uint8_t *mask, size_t n) { Equal(Raw(a), Raw(b), mask, n); }
+inline void Select(const uint8_t *mask, const Fix64 *a, const Fix64 *b, Fix64 *out, size_t n) {
+  Select(mask, Raw(a), Raw(b), Raw(out), n);
+}
+
+} // namespace fix64_batch
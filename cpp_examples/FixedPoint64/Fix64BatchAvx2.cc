@@ -0,0 +1,203 @@
+// Fix64Batch 的 AVX2 实现，使用 -mavx2 (/arch:AVX2) 编译
+// 乘法没有 64 位的高位乘法指令，用 4 个 32x32->64 的部分积拼出 128 位的乘积，
+// 舍入用的一半直接加在最低的部分积上（不会溢出），所以不需要再处理进位
+
+#include "Fix64BatchKernels.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+#include <string.h>
+
+namespace fix64_batch {
+namespace detail {
+namespace {
+
+constexpr size_t kLanes = 4;
+
+inline __m256i Load(const int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+inline void Store(int64_t *p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+
+// 负数的 lane 全 1
+inline __m256i SignMask(__m256i v) { return _mm256_cmpgt_epi64(_mm256_setzero_si256(), v); }
+
+// 结果为正时 INT64_MAX，为负时 INT64_MIN
+inline __m256i Saturated(__m256i negative) { return _mm256_xor_si256(_mm256_set1_epi64x(INT64_MAX), negative); }
+
+// (|a| * |b| + kHalf) >> kFracBit：q 是低 64 位，qhi 是更高的位，negative 是结果的符号
+struct Product {
+  __m256i q, qhi, negative;
+};
+
+inline Product MulMagnitude(__m256i a, __m256i b) {
+  __m256i sa = SignMask(a), sb = SignMask(b);
+  __m256i ua = _mm256_sub_epi64(_mm256_xor_si256(a, sa), sa);
+  __m256i ub = _mm256_sub_epi64(_mm256_xor_si256(b, sb), sb);
+  __m256i a1 = _mm256_srli_epi64(ua, 32), b1 = _mm256_srli_epi64(ub, 32);
+  __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+
+  __m256i p00 = _mm256_add_epi64(_mm256_mul_epu32(ua, ub), _mm256_set1_epi64x(Fix64::kHalf));
+  __m256i p01 = _mm256_mul_epu32(ua, b1);
+  __m256i p10 = _mm256_mul_epu32(a1, ub);
+  __m256i p11 = _mm256_mul_epu32(a1, b1);
+  __m256i mid = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(p00, 32), _mm256_and_si256(p01, low)),
+                                 _mm256_and_si256(p10, low));
+  __m256i lo = _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(p00, low));
+  __m256i hi = _mm256_add_epi64(_mm256_add_epi64(p11, _mm256_srli_epi64(p01, 32)),
+                                _mm256_add_epi64(_mm256_srli_epi64(p10, 32), _mm256_srli_epi64(mid, 32)));
+
+  Product r;
+  r.q = _mm256_or_si256(_mm256_srli_epi64(lo, kFracBit), _mm256_slli_epi64(hi, 64 - kFracBit));
+  r.qhi = _mm256_srli_epi64(hi, kFracBit);
+  r.negative = _mm256_xor_si256(sa, sb);
+  return r;
+}
+
+inline __m256i ApplySign(__m256i q, __m256i negative) {
+  return _mm256_sub_epi64(_mm256_xor_si256(q, negative), negative);
+}
+
+inline __m256i MulWrap(__m256i a, __m256i b) {
+  Product p = MulMagnitude(a, b);
+  return ApplySign(p.q, p.negative);
+}
+
+inline __m256i MulSaturate(__m256i a, __m256i b) {
+  Product p = MulMagnitude(a, b);
+  __m256i zero = _mm256_setzero_si256();
+  // 溢出：qhi 不为 0，或者 q 不小于 2^63；结果为负时 q == 2^63 正好是 INT64_MIN
+  __m256i highBits = _mm256_xor_si256(_mm256_cmpeq_epi64(p.qhi, zero), _mm256_set1_epi64x(-1));
+  __m256i exactMin = _mm256_and_si256(p.negative, _mm256_cmpeq_epi64(p.q, _mm256_set1_epi64x(INT64_MIN)));
+  __m256i overflow = _mm256_or_si256(highBits, _mm256_andnot_si256(exactMin, SignMask(p.q)));
+  return _mm256_blendv_epi8(ApplySign(p.q, p.negative), Saturated(p.negative), overflow);
+}
+
+inline __m256i SafeAddVec(__m256i a, __m256i b) {
+  __m256i s = _mm256_add_epi64(a, b);
+  __m256i overflow = SignMask(_mm256_and_si256(_mm256_xor_si256(a, s), _mm256_xor_si256(b, s)));
+  return _mm256_blendv_epi8(s, Saturated(SignMask(a)), overflow);
+}
+
+inline __m256i SafeSubVec(__m256i a, __m256i b) {
+  __m256i s = _mm256_sub_epi64(a, b);
+  __m256i overflow = SignMask(_mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, s)));
+  return _mm256_blendv_epi8(s, Saturated(SignMask(a)), overflow);
+}
+
+struct AddOp {
+  static __m256i Vec(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::add;
+};
+struct SubOp {
+  static __m256i Vec(__m256i a, __m256i b) { return _mm256_sub_epi64(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::sub;
+};
+struct MulOp {
+  static __m256i Vec(__m256i a, __m256i b) { return MulWrap(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::mul;
+};
+struct SafeAddOp {
+  static __m256i Vec(__m256i a, __m256i b) { return SafeAddVec(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeAdd;
+};
+struct SafeSubOp {
+  static __m256i Vec(__m256i a, __m256i b) { return SafeSubVec(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeSub;
+};
+struct SafeMulOp {
+  static __m256i Vec(__m256i a, __m256i b) { return MulSaturate(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeMul;
+};
+struct MulAddOp {
+  static __m256i Vec(__m256i a, __m256i b, __m256i c) { return _mm256_add_epi64(MulWrap(a, b), c); }
+  static constexpr TernaryFn Kernels::*tail = &Kernels::mulAdd;
+};
+struct SafeMulAddOp {
+  static __m256i Vec(__m256i a, __m256i b, __m256i c) { return SafeAddVec(MulSaturate(a, b), c); }
+  static constexpr TernaryFn Kernels::*tail = &Kernels::safeMulAdd;
+};
+
+template <typename Op>
+void BinaryVec(const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, Op::Vec(Load(a + i), Load(b + i)));
+  (ScalarKernels().*Op::tail)(a + i, b + i, out + i, n - i);
+}
+
+template <typename Op>
+void TernaryVec(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, Op::Vec(Load(a + i), Load(b + i), Load(c + i)));
+  (ScalarKernels().*Op::tail)(a + i, b + i, c + i, out + i, n - i);
+}
+
+// 4 位的比较结果展开成 4 个字节
+inline void StoreMask(uint8_t *mask, __m256i lanes) {
+  static const uint32_t kBytes[16] = {
+      0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+      0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101,
+  };
+  uint32_t bytes = kBytes[_mm256_movemask_pd(_mm256_castsi256_pd(lanes))];
+  memcpy(mask, &bytes, sizeof(bytes));
+}
+
+void LessVec(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    StoreMask(mask + i, _mm256_cmpgt_epi64(Load(b + i), Load(a + i)));
+  ScalarKernels().less(a + i, b + i, mask + i, n - i);
+}
+
+void EqualVec(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    StoreMask(mask + i, _mm256_cmpeq_epi64(Load(a + i), Load(b + i)));
+  ScalarKernels().equal(a + i, b + i, mask + i, n - i);
+}
+
+void SelectVec(const uint8_t *mask, const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    int32_t bytes;
+    memcpy(&bytes, mask + i, sizeof(bytes));
+    __m256i m = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+    __m256i pickB = _mm256_cmpeq_epi64(m, _mm256_setzero_si256());
+    Store(out + i, _mm256_blendv_epi8(Load(a + i), Load(b + i), pickB));
+  }
+  ScalarKernels().select(mask + i, a + i, b + i, out + i, n - i);
+}
+
+void ScaleAddVec(const int64_t *a, int64_t s, const int64_t *c, int64_t *out, size_t n) {
+  __m256i vs = _mm256_set1_epi64x(s);
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, MulAddOp::Vec(Load(a + i), vs, Load(c + i)));
+  ScalarKernels().scaleAdd(a + i, s, c + i, out + i, n - i);
+}
+
+} // namespace
+
+const Kernels *Avx2Kernels() {
+  // 除法没有 SIMD 版本
+  static const Kernels kernels = {
+      BinaryVec<AddOp>,     BinaryVec<SubOp>,         BinaryVec<MulOp>,     ScalarKernels().div,
+      TernaryVec<MulAddOp>, BinaryVec<SafeAddOp>,     BinaryVec<SafeSubOp>, BinaryVec<SafeMulOp>,
+      ScalarKernels().safeDiv, TernaryVec<SafeMulAddOp>, LessVec, EqualVec, SelectVec, ScaleAddVec,
+  };
+  return &kernels;
+}
+
+} // namespace detail
+} // namespace fix64_batch
+
+#else
+
+namespace fix64_batch {
+namespace detail {
+const Kernels *Avx2Kernels() { return nullptr; }
+} // namespace detail
+} // namespace fix64_batch
+
+#endif
@@ -0,0 +1,193 @@
+// Fix64Batch 的 AVX-512 实现，使用 -mavx512f -mavx512bw -mavx512vl (/arch:AVX512) 编译
+// 和 AVX2 版本的算法相同（见 Fix64BatchAvx2.cc），8 个 lane，符号和溢出用 mask 寄存器
+
+#include "Fix64BatchKernels.h"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12 的 avx512fintrin.h 用 _mm512_undefined_* 做未使用的源操作数，会误报
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+
+namespace fix64_batch {
+namespace detail {
+namespace {
+
+constexpr size_t kLanes = 8;
+
+inline __m512i Load(const int64_t *p) { return _mm512_loadu_si512(p); }
+inline void Store(int64_t *p, __m512i v) { _mm512_storeu_si512(p, v); }
+
+inline __mmask8 Negative(__m512i v) { return _mm512_cmplt_epi64_mask(v, _mm512_setzero_si512()); }
+
+// 结果为正时 INT64_MAX，为负时 INT64_MIN
+inline __m512i Saturated(__mmask8 negative) {
+  return _mm512_mask_blend_epi64(negative, _mm512_set1_epi64(INT64_MAX), _mm512_set1_epi64(INT64_MIN));
+}
+
+struct Product {
+  __m512i q, qhi;
+  __mmask8 negative;
+};
+
+inline Product MulMagnitude(__m512i a, __m512i b) {
+  __m512i ua = _mm512_abs_epi64(a), ub = _mm512_abs_epi64(b);
+  __m512i a1 = _mm512_srli_epi64(ua, 32), b1 = _mm512_srli_epi64(ub, 32);
+  __m512i low = _mm512_set1_epi64(0xFFFFFFFF);
+
+  __m512i p00 = _mm512_add_epi64(_mm512_mul_epu32(ua, ub), _mm512_set1_epi64(Fix64::kHalf));
+  __m512i p01 = _mm512_mul_epu32(ua, b1);
+  __m512i p10 = _mm512_mul_epu32(a1, ub);
+  __m512i p11 = _mm512_mul_epu32(a1, b1);
+  __m512i mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(p00, 32), _mm512_and_si512(p01, low)),
+                                 _mm512_and_si512(p10, low));
+  __m512i lo = _mm512_or_si512(_mm512_slli_epi64(mid, 32), _mm512_and_si512(p00, low));
+  __m512i hi = _mm512_add_epi64(_mm512_add_epi64(p11, _mm512_srli_epi64(p01, 32)),
+                                _mm512_add_epi64(_mm512_srli_epi64(p10, 32), _mm512_srli_epi64(mid, 32)));
+
+  Product r;
+  r.q = _mm512_or_si512(_mm512_srli_epi64(lo, kFracBit), _mm512_slli_epi64(hi, 64 - kFracBit));
+  r.qhi = _mm512_srli_epi64(hi, kFracBit);
+  r.negative = Negative(_mm512_xor_si512(a, b));
+  return r;
+}
+
+inline __m512i ApplySign(const Product &p) {
+  return _mm512_mask_sub_epi64(p.q, p.negative, _mm512_setzero_si512(), p.q);
+}
+
+inline __m512i MulWrap(__m512i a, __m512i b) { return ApplySign(MulMagnitude(a, b)); }
+
+inline __m512i MulSaturate(__m512i a, __m512i b) {
+  Product p = MulMagnitude(a, b);
+  // 溢出：qhi 不为 0，或者 q 不小于 2^63；结果为负时 q == 2^63 正好是 INT64_MIN
+  __mmask8 highBits = _mm512_test_epi64_mask(p.qhi, p.qhi);
+  __mmask8 exactMin = p.negative & _mm512_cmpeq_epi64_mask(p.q, _mm512_set1_epi64(INT64_MIN));
+  __mmask8 overflow = highBits | (Negative(p.q) & ~exactMin);
+  return _mm512_mask_blend_epi64(overflow, ApplySign(p), Saturated(p.negative));
+}
+
+inline __m512i SafeAddVec(__m512i a, __m512i b) {
+  __m512i s = _mm512_add_epi64(a, b);
+  __mmask8 overflow = Negative(_mm512_and_si512(_mm512_xor_si512(a, s), _mm512_xor_si512(b, s)));
+  return _mm512_mask_blend_epi64(overflow, s, Saturated(Negative(a)));
+}
+
+inline __m512i SafeSubVec(__m512i a, __m512i b) {
+  __m512i s = _mm512_sub_epi64(a, b);
+  __mmask8 overflow = Negative(_mm512_and_si512(_mm512_xor_si512(a, b), _mm512_xor_si512(a, s)));
+  return _mm512_mask_blend_epi64(overflow, s, Saturated(Negative(a)));
+}
+
+struct AddOp {
+  static __m512i Vec(__m512i a, __m512i b) { return _mm512_add_epi64(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::add;
+};
+struct SubOp {
+  static __m512i Vec(__m512i a, __m512i b) { return _mm512_sub_epi64(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::sub;
+};
+struct MulOp {
+  static __m512i Vec(__m512i a, __m512i b) { return MulWrap(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::mul;
+};
+struct SafeAddOp {
+  static __m512i Vec(__m512i a, __m512i b) { return SafeAddVec(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeAdd;
+};
+struct SafeSubOp {
+  static __m512i Vec(__m512i a, __m512i b) { return SafeSubVec(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeSub;
+};
+struct SafeMulOp {
+  static __m512i Vec(__m512i a, __m512i b) { return MulSaturate(a, b); }
+  static constexpr BinaryFn Kernels::*tail = &Kernels::safeMul;
+};
+struct MulAddOp {
+  static __m512i Vec(__m512i a, __m512i b, __m512i c) { return _mm512_add_epi64(MulWrap(a, b), c); }
+  static constexpr TernaryFn Kernels::*tail = &Kernels::mulAdd;
+};
+struct SafeMulAddOp {
+  static __m512i Vec(__m512i a, __m512i b, __m512i c) { return SafeAddVec(MulSaturate(a, b), c); }
+  static constexpr TernaryFn Kernels::*tail = &Kernels::safeMulAdd;
+};
+
+template <typename Op>
+void BinaryVec(const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, Op::Vec(Load(a + i), Load(b + i)));
+  (ScalarKernels().*Op::tail)(a + i, b + i, out + i, n - i);
+}
+
+template <typename Op>
+void TernaryVec(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, Op::Vec(Load(a + i), Load(b + i), Load(c + i)));
+  (ScalarKernels().*Op::tail)(a + i, b + i, c + i, out + i, n - i);
+}
+
+// 8 位的比较结果展开成 8 个字节
+inline void StoreMask(uint8_t *mask, __mmask8 lanes) {
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(mask), _mm_maskz_set1_epi8(lanes, 1));
+}
+
+void LessVec(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    StoreMask(mask + i, _mm512_cmplt_epi64_mask(Load(a + i), Load(b + i)));
+  ScalarKernels().less(a + i, b + i, mask + i, n - i);
+}
+
+void EqualVec(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    StoreMask(mask + i, _mm512_cmpeq_epi64_mask(Load(a + i), Load(b + i)));
+  ScalarKernels().equal(a + i, b + i, mask + i, n - i);
+}
+
+void SelectVec(const uint8_t *mask, const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    __m512i m = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(mask + i)));
+    __mmask8 pickA = _mm512_test_epi64_mask(m, m);
+    Store(out + i, _mm512_mask_blend_epi64(pickA, Load(b + i), Load(a + i)));
+  }
+  ScalarKernels().select(mask + i, a + i, b + i, out + i, n - i);
+}
+
+void ScaleAddVec(const int64_t *a, int64_t s, const int64_t *c, int64_t *out, size_t n) {
+  __m512i vs = _mm512_set1_epi64(s);
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes)
+    Store(out + i, MulAddOp::Vec(Load(a + i), vs, Load(c + i)));
+  ScalarKernels().scaleAdd(a + i, s, c + i, out + i, n - i);
+}
+
+} // namespace
+
+const Kernels *Avx512Kernels() {
+  // 除法没有 SIMD 版本
+  static const Kernels kernels = {
+      BinaryVec<AddOp>,     BinaryVec<SubOp>,         BinaryVec<MulOp>,     ScalarKernels().div,
+      TernaryVec<MulAddOp>, BinaryVec<SafeAddOp>,     BinaryVec<SafeSubOp>, BinaryVec<SafeMulOp>,
+      ScalarKernels().safeDiv, TernaryVec<SafeMulAddOp>, LessVec, EqualVec, SelectVec, ScaleAddVec,
+  };
+  return &kernels;
+}
+
+} // namespace detail
+} // namespace fix64_batch
+
+#else
+
+namespace fix64_batch {
+namespace detail {
+const Kernels *Avx512Kernels() { return nullptr; }
+} // namespace detail
+} // namespace fix64_batch
+
+#endif
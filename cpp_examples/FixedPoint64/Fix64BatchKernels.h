@@ -0,0 +1,97 @@
+// Fix64Batch 内部：每个指令集一组 kernel
+// 标量的单元素运算在这里，只在不带指令集参数编译的 Fix64Batch.cc 里使用。
+// SIMD 的文件处理尾部时通过 ScalarKernels() 调用，不直接用这些 inline 函数：
+// 否则链接器可能把带 AVX 指令编译的那一份给所有人用
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Fix64.h"
+#include "Fix64Wide.h"
+
+namespace fix64_batch {
+namespace detail {
+
+typedef void (*BinaryFn)(const int64_t *, const int64_t *, int64_t *, size_t);
+typedef void (*TernaryFn)(const int64_t *, const int64_t *, const int64_t *, int64_t *, size_t);
+typedef void (*CompareFn)(const int64_t *, const int64_t *, uint8_t *, size_t);
+typedef void (*SelectFn)(const uint8_t *, const int64_t *, const int64_t *, int64_t *, size_t);
+typedef void (*ScaleFn)(const int64_t *, int64_t, const int64_t *, int64_t *, size_t);
+
+struct Kernels {
+  BinaryFn add, sub, mul, div;
+  TernaryFn mulAdd;
+  BinaryFn safeAdd, safeSub, safeMul, safeDiv;
+  TernaryFn safeMulAdd;
+  CompareFn less, equal;
+  SelectFn select;
+  ScaleFn scaleAdd;
+};
+
+// 和 Fix64 的运算符逐位相同；加减用无符号数回绕，避免有符号溢出
+inline int64_t AddOne(int64_t a, int64_t b) { return int64_t(uint64_t(a) + uint64_t(b)); }
+inline int64_t SubOne(int64_t a, int64_t b) { return int64_t(uint64_t(a) - uint64_t(b)); }
+inline int64_t MulOne(int64_t a, int64_t b) { return fix64_detail::Mul<kFracBit>(a, b, false); }
+inline int64_t DivOne(int64_t a, int64_t b) { return fix64_detail::Div<kFracBit>(a, b, false); }
+inline int64_t MulAddOne(int64_t a, int64_t b, int64_t c) { return AddOne(MulOne(a, b), c); }
+
+inline int64_t SafeAddOne(int64_t a, int64_t b) {
+  int64_t s = AddOne(a, b);
+  // 两个加数同号而和的符号不同时溢出，方向由 a 的符号决定
+  if (((a ^ s) & (b ^ s)) < 0)
+    return a < 0 ? INT64_MIN : INT64_MAX;
+  return s;
+}
+
+inline int64_t SafeSubOne(int64_t a, int64_t b) {
+  int64_t s = SubOne(a, b);
+  if (((a ^ b) & (a ^ s)) < 0)
+    return a < 0 ? INT64_MIN : INT64_MAX;
+  return s;
+}
+
+inline int64_t SafeMulOne(int64_t a, int64_t b) { return fix64_detail::Mul<kFracBit>(a, b, true); }
+inline int64_t SafeDivOne(int64_t a, int64_t b) { return fix64_detail::Div<kFracBit>(a, b, true); }
+inline int64_t SafeMulAddOne(int64_t a, int64_t b, int64_t c) { return SafeAddOne(SafeMulOne(a, b), c); }
+
+template <int64_t (*Op)(int64_t, int64_t)>
+void Binary(const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = Op(a[i], b[i]);
+}
+
+template <int64_t (*Op)(int64_t, int64_t, int64_t)>
+void Ternary(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = Op(a[i], b[i], c[i]);
+}
+
+inline void LessScalar(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    mask[i] = a[i] < b[i];
+}
+
+inline void EqualScalar(const int64_t *a, const int64_t *b, uint8_t *mask, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    mask[i] = a[i] == b[i];
+}
+
+inline void SelectScalar(const uint8_t *mask, const int64_t *a, const int64_t *b, int64_t *out, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = mask[i] ? a[i] : b[i];
+}
+
+inline void ScaleAddScalar(const int64_t *a, int64_t s, const int64_t *c, int64_t *out, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = MulAddOne(a[i], s, c[i]);
+}
+
+const Kernels &ScalarKernels();
+// 没有编译进来时（不是 x86，或者编译器不支持对应的选项）返回 nullptr
+const Kernels *Avx2Kernels();
+const Kernels *Avx512Kernels();
+
+} // namespace detail
+} // namespace fix64_batch
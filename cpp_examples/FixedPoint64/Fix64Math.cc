@@ -0,0 +1,388 @@
+// Fix64Math 的实现
+// 角度（Sin/Cos/Atan2）的结果不超过 pi，只需要绝对精度：内部用 Q30，乘积放得进 int64
+// Exp/Log/Pow 的结果可以到 2^39，需要相对精度：内部用 Q57/Q61，乘法用 Fix64Wide 的 128 位乘法
+// 查找表在编译期用 Fix64Wide 的 Portable 乘除法求级数（Q61）生成，再舍入到需要的精度
+
+#include "Fix64Math.h"
+
+#include <array>
+
+#include "Fix64Wide.h"
+
+namespace fix64_math {
+namespace {
+
+using fix64_detail::Magnitude;
+
+constexpr int64_t kOneQ30 = 1LL << 30;
+constexpr int64_t kOneQ61 = 1LL << 61;
+
+constexpr int64_t kHalfPiQ30 = 1686629713;
+constexpr int64_t kPiQ30 = 3373259426;
+constexpr int64_t kInvTwoPiQ62 = 733972625820500307; // 1 / (2 pi)
+constexpr int64_t kHalfPiQ61 = 3622009729038561421;
+constexpr int64_t kLn2Q61 = 1598288580650331957;
+constexpr int64_t kLog2EQ61 = 3326628274461080623; // 1 / ln 2
+constexpr int64_t kLn2Q57 = 99893036290645747;
+
+// 右移并舍入到最近，一半时远离 0；0 < shift < 64
+constexpr int64_t RoundShift(int64_t v, int shift) {
+  int64_t m = int64_t((Magnitude(v) + (1ULL << (shift - 1))) >> shift);
+  return v < 0 ? -m : m;
+}
+
+int BitLength(uint64_t v) {
+#if defined(__GNUC__)
+  return 64 - __builtin_clzll(v);
+#else
+  return 64 - fix64_detail::CountLeadingZeros(v);
+#endif
+}
+
+// ---- 编译期生成查找表 ----
+
+constexpr int64_t GenMul(int64_t a, int64_t b) { return fix64_detail::MulPortable<61>(a, b, false); }
+constexpr int64_t GenDiv(int64_t a, int64_t b) { return fix64_detail::DivPortable<61>(a, b, false); }
+
+// sin(x)，|x| <= pi / 2
+constexpr int64_t SinSeries(int64_t x) {
+  int64_t x2 = GenMul(x, x);
+  int64_t term = x, sum = x;
+  for (int n = 1; term != 0; ++n) {
+    term = -GenMul(term, x2) / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+// atan(k / n)，0 <= k <= n，Euler 的级数：
+// atan(x) = x / (1 + x^2) * sum((2i)!! / (2i + 1)!! * y^i)，y = x^2 / (1 + x^2) <= 1 / 2
+constexpr int64_t AtanSeries(int64_t k, int64_t n) {
+  int64_t term = GenDiv(k * n, n * n + k * k);
+  int64_t y = GenDiv(k * k, n * n + k * k);
+  int64_t sum = term;
+  for (int i = 1; term != 0; ++i) {
+    term = GenMul(term, y) / (2 * i + 1) * (2 * i);
+    sum += term;
+  }
+  return sum;
+}
+
+// e^x，0 <= x < 1
+constexpr int64_t ExpSeries(int64_t x) {
+  int64_t term = kOneQ61, sum = kOneQ61;
+  for (int n = 1; term != 0; ++n) {
+    term = GenMul(term, x) / n;
+    sum += term;
+  }
+  return sum;
+}
+
+// ln(a / b)，b <= a <= 2b：2 atanh(s)，s = (a - b) / (a + b) <= 1 / 3
+constexpr int64_t LogSeries(int64_t a, int64_t b) {
+  int64_t s = GenDiv(a - b, a + b);
+  int64_t s2 = GenMul(s, s);
+  int64_t sum = 0;
+  for (int64_t power = s, n = 1; power != 0; power = GenMul(power, s2), n += 2)
+    sum += power / n;
+  return 2 * sum;
+}
+
+constexpr int kSinTableBits = 8;
+constexpr int kSinTableSize = 1 << kSinTableBits;
+constexpr int64_t kSinStepQ40 = 6746518852; // (pi / 2) / kSinTableSize
+
+// sin(k * (pi / 2) / N)，k = 0..N，Q30；cos 用 N - k
+constexpr std::array<int32_t, kSinTableSize + 1> MakeSinTable() {
+  std::array<int32_t, kSinTableSize + 1> table{};
+  for (int k = 0; k <= kSinTableSize; ++k)
+    table[k] = int32_t(RoundShift(SinSeries(fix64_detail::MulPortable<kSinTableBits>(kHalfPiQ61, k, false)), 31));
+  return table;
+}
+
+constexpr int kAtanTableBits = 8;
+constexpr int kAtanTableSize = 1 << kAtanTableBits;
+
+// atan(k / N)，k = 0..N，Q30
+constexpr std::array<int32_t, kAtanTableSize + 1> MakeAtanTable() {
+  std::array<int32_t, kAtanTableSize + 1> table{};
+  for (int k = 0; k <= kAtanTableSize; ++k)
+    table[k] = int32_t(RoundShift(AtanSeries(k, kAtanTableSize), 31));
+  return table;
+}
+
+constexpr int kExpTableBits = 8;
+constexpr int kExpTableSize = 1 << kExpTableBits;
+
+// 2^(k / N)，k = 0..N-1，Q61
+constexpr std::array<int64_t, kExpTableSize> MakeExp2Table() {
+  std::array<int64_t, kExpTableSize> table{};
+  for (int k = 0; k < kExpTableSize; ++k)
+    table[k] = ExpSeries(fix64_detail::MulPortable<kExpTableBits>(kLn2Q61, k, false));
+  return table;
+}
+
+constexpr int kLogTableBits = 8;
+constexpr int kLogTableSize = 1 << kLogTableBits;
+
+// c = 1 + k / N，k = 0..N-1：1 / c 和 ln(c)，Q61
+constexpr std::array<int64_t, kLogTableSize> MakeReciprocalTable() {
+  std::array<int64_t, kLogTableSize> table{};
+  for (int k = 0; k < kLogTableSize; ++k)
+    table[k] = GenDiv(kLogTableSize, kLogTableSize + k);
+  return table;
+}
+
+constexpr std::array<int64_t, kLogTableSize> MakeLogTable() {
+  std::array<int64_t, kLogTableSize> table{};
+  for (int k = 0; k < kLogTableSize; ++k)
+    table[k] = LogSeries(kLogTableSize + k, kLogTableSize);
+  return table;
+}
+
+constexpr int kRsqrtTableBits = 8;
+
+// 1 / sqrt(x)，x = (k + 1/2) / 2^(kRsqrtTableBits - 1) 在 [1/2, 2) 里，Q30；Sqrt 的初值
+constexpr std::array<int32_t, 1 << kRsqrtTableBits> MakeRsqrtTable() {
+  std::array<int32_t, 1 << kRsqrtTableBits> table{};
+  for (int k = 1 << (kRsqrtTableBits - 2); k < (1 << kRsqrtTableBits); ++k) {
+    int64_t x = int64_t(2 * k + 1) << (61 - kRsqrtTableBits);
+    int64_t y = kOneQ61;
+    for (int i = 0; i < 20; ++i)
+      y = GenMul(y, 3 * kOneQ61 - GenMul(x, GenMul(y, y))) / 2;
+    table[k] = int32_t(RoundShift(y, 31));
+  }
+  return table;
+}
+
+constexpr auto kRsqrtTable = MakeRsqrtTable();
+constexpr auto kSinTable = MakeSinTable();
+constexpr auto kAtanTable = MakeAtanTable();
+constexpr auto kExp2Table = MakeExp2Table();
+constexpr auto kReciprocalTable = MakeReciprocalTable();
+constexpr auto kLogTable = MakeLogTable();
+
+static_assert(kRsqrtTable[1 << (kRsqrtTableBits - 1)] == 1071650796, "1 / sqrt(1 + 1/256)");
+static_assert(kSinTable[kSinTableSize] == kOneQ30, "sin(pi / 2) == 1");
+static_assert(kAtanTable[kAtanTableSize] == 843314857, "atan(1) == pi / 4");
+static_assert(RoundShift(ExpSeries(kOneQ61), 37) == kE, "e");
+static_assert(RoundShift(LogSeries(2, 1), 37) == kLn2, "ln(2)");
+
+// ---- 运行时 ----
+
+inline int64_t MulQ61(int64_t a, int64_t b) { return fix64_detail::Mul<61>(a, b, false); }
+
+inline fix64_detail::U128 Square(uint64_t v) {
+#ifdef FIX64_HAS_INT128
+  fix64_detail::uint128_t p = fix64_detail::uint128_t(v) * v;
+  return {uint64_t(p >> 64), uint64_t(p)};
+#else
+  return fix64_detail::MulU64(v, v);
+#endif
+}
+
+inline bool Less(fix64_detail::U128 a, fix64_detail::U128 b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+
+struct SinCosQ30 {
+  int64_t sin, cos;
+};
+
+SinCosQ30 SinCosOf(int64_t raw) {
+  // 角度换成圈数（Q56），整圈的部分在 64 位里回绕掉；sin 是奇函数，cos 是偶函数，按 |x| 计算
+  uint64_t turns = uint64_t(fix64_detail::Mul<30>(raw, kInvTwoPiQ62, false));
+  if (raw < 0)
+    turns = 0 - turns;
+  int quadrant = int(turns >> 54) & 3;
+  uint64_t inQuadrant = turns & ((1ULL << 54) - 1);
+  int index = int(inQuadrant >> (54 - kSinTableBits));
+
+  // 到表中角度的距离 d < (pi / 2) / N：sin(d) = d - d^3 / 6，cos(d) = 1 - d^2 / 2，后面的项小于 2^-33
+  int64_t step = int64_t(inQuadrant >> (54 - kSinTableBits - 30)) & (kOneQ30 - 1);
+  int64_t d = RoundShift(step * kSinStepQ40, 40);
+  int64_t d2 = RoundShift(d * d, 30);
+  int64_t sinD = d - RoundShift(d2 * d, 30) / 6;
+  int64_t cosD = kOneQ30 - RoundShift(d2, 1);
+
+  int64_t s = kSinTable[index], c = kSinTable[kSinTableSize - index];
+  int64_t sinA = RoundShift(s * cosD + c * sinD, 30);
+  int64_t cosA = RoundShift(c * cosD - s * sinD, 30);
+
+  SinCosQ30 r = {0, 0};
+  switch (quadrant) {
+  case 0:
+    r = {sinA, cosA};
+    break;
+  case 1:
+    r = {cosA, -sinA};
+    break;
+  case 2:
+    r = {-sinA, -cosA};
+    break;
+  default:
+    r = {-cosA, sinA};
+    break;
+  }
+  if (raw < 0)
+    r.sin = -r.sin;
+  return r;
+}
+
+// ln(v * 2^-kFracBit)，v > 0，Q57
+int64_t LnQ57(uint64_t v) {
+  // v = m * 2^top，m 在 [1, 2)，Q61
+  int top = BitLength(v) - 1;
+  int64_t m = int64_t(top <= 61 ? v << (61 - top) : v >> (top - 61));
+  int index = int(m >> (61 - kLogTableBits)) & (kLogTableSize - 1);
+
+  // ln(m) = ln(c) + log1p(z)，z = m / c - 1 < 1 / N，级数到 z^7
+  int64_t z = MulQ61(m, kReciprocalTable[index]) - kOneQ61;
+  int64_t p = kOneQ61 / 7;
+  for (int n = 6; n >= 1; --n)
+    p = kOneQ61 / n - MulQ61(z, p);
+  int64_t lnM = kLogTable[index] + MulQ61(z, p);
+  return (top - kFracBit) * kLn2Q57 + RoundShift(lnM, 4);
+}
+
+// e^u，u 是 Q57，返回 Fix64 的 raw 值
+int64_t ExpRaw(int64_t u) {
+  // e^28 超过 kMax，e^-18 舍入到 0
+  if (u >= 28 * (1LL << 57))
+    return Fix64::kMax;
+  if (u <= -18 * (1LL << 57))
+    return 0;
+
+  // e^u = 2^t = 2^k * 2^(i / N) * e^y
+  int64_t t = MulQ61(u, kLog2EQ61);
+  int64_t k = t >> 57;
+  int64_t f = t & ((1LL << 57) - 1);
+  int index = int(f >> (57 - kExpTableBits));
+  int64_t y = fix64_detail::Mul<57>(f & ((1LL << (57 - kExpTableBits)) - 1), kLn2Q61, false);
+
+  // y < ln(2) / N，级数到 y^6
+  int64_t q = kOneQ61;
+  for (int n = 6; n >= 1; --n)
+    q = kOneQ61 + MulQ61(y, q) / n;
+  int64_t m = MulQ61(kExp2Table[index], q);
+
+  // m * 2^k 换成 Q24
+  int shift = int(k) - (61 - kFracBit);
+  if (shift >= 0)
+    return m > (Fix64::kMax >> shift) ? Fix64::kMax : m << shift;
+  return RoundShift(m, -shift);
+}
+
+} // namespace
+
+Fix64 Sqrt(const Fix64 &x) {
+  int64_t v = x.GetRaw();
+  if (v <= 0)
+    return Fix64::FromRaw(0);
+
+  // v = m / 4^s，m 在 [2^61, 2^63)；sqrt(v * 2^kFracBit) = sqrt(M) / 2^s，M = m * 2^kFracBit
+  int shift = (62 - (BitLength(uint64_t(v)) - 1)) & ~1;
+  uint64_t m = uint64_t(v) << shift;
+  int s = shift / 2;
+
+  // y ≈ 1 / sqrt(m / 2^62)：查表得到 8 位，两次 Newton 迭代到 Q30 的精度
+  int64_t xq = int64_t(m >> 32);
+  int64_t y = kRsqrtTable[m >> (63 - kRsqrtTableBits)];
+  for (int i = 0; i < 2; ++i)
+    y = (y * (3 * kOneQ30 - ((xq * ((y * y) >> 30)) >> 30))) >> 31;
+
+  // r ≈ sqrt(M) 的误差在 2^15 以内；再用 M - r^2 做一次 Newton 修正，剩下的误差不超过 1
+  uint64_t r = uint64_t(xq * y) >> (60 - (62 + kFracBit) / 2);
+  fix64_detail::U128 big = {m >> (64 - kFracBit), m << kFracBit};
+  int64_t diff = int64_t(big.lo - Square(r).lo); // |M - r^2| < 2^63，低 64 位就是差
+  r = uint64_t(int64_t(r) + diff / int64_t(2 * r));
+  while (Less(big, Square(r)))
+    --r;
+  while (!Less(big, Square(r + 1)))
+    ++r;
+
+  // r = floor(sqrt(M))，舍入到最近
+  if (s > 0)
+    return Fix64::FromRaw(int64_t((r + (1ULL << (s - 1))) >> s));
+  return Fix64::FromRaw(int64_t(r + (big.lo - Square(r).lo > r ? 1 : 0)));
+}
+
+Fix64 Sin(const Fix64 &x) { return Fix64::FromRaw(RoundShift(SinCosOf(x.GetRaw()).sin, 30 - kFracBit)); }
+
+Fix64 Cos(const Fix64 &x) { return Fix64::FromRaw(RoundShift(SinCosOf(x.GetRaw()).cos, 30 - kFracBit)); }
+
+void SinCos(const Fix64 &x, Fix64 *sin, Fix64 *cos) {
+  SinCosQ30 r = SinCosOf(x.GetRaw());
+  *sin = Fix64::FromRaw(RoundShift(r.sin, 30 - kFracBit));
+  *cos = Fix64::FromRaw(RoundShift(r.cos, 30 - kFracBit));
+}
+
+Fix64 Atan2(const Fix64 &y, const Fix64 &x) {
+  int64_t yr = y.GetRaw(), xr = x.GetRaw();
+  if (xr == 0 && yr == 0)
+    return Fix64::FromRaw(0);
+
+  // 换到第一象限的下半部分：t = min / max in [0, 1]，Q30
+  uint64_t ax = Magnitude(xr), ay = Magnitude(yr);
+  bool swap = ay > ax;
+  uint64_t num = swap ? ax : ay, den = swap ? ay : ax;
+  int shift = BitLength(den) - 32;
+  if (shift > 0) {
+    num >>= shift;
+    den >>= shift;
+  }
+  int64_t t = int64_t(((num << 30) + den / 2) / den);
+
+  // atan(t) = atan(t_k) + atan(delta)，delta = (t - t_k) / (1 + t t_k)，t_k 是最近的表中的值
+  // |delta| <= 1 / 2N：atan(delta) = delta - delta^3 / 3，后面的项小于 2^-45
+  int index = int((t + (1LL << (29 - kAtanTableBits))) >> (30 - kAtanTableBits));
+  int64_t tk = int64_t(index) << (30 - kAtanTableBits);
+  int64_t delta = ((t - tk) * kOneQ30) / (kOneQ30 + RoundShift(t * tk, 30));
+  int64_t delta3 = RoundShift(RoundShift(delta * delta, 30) * delta, 30);
+  int64_t angle = kAtanTable[index] + delta - delta3 / 3;
+
+  if (swap)
+    angle = kHalfPiQ30 - angle;
+  if (xr < 0)
+    angle = kPiQ30 - angle;
+  if (yr < 0)
+    angle = -angle;
+  return Fix64::FromRaw(RoundShift(angle, 30 - kFracBit));
+}
+
+Fix64 Exp(const Fix64 &x) {
+  int64_t v = x.GetRaw();
+  // |x| >= 64 放不进 Q57，结果早已饱和或者是 0
+  if (v >= (64LL << kFracBit))
+    return Fix64::FromRaw(Fix64::kMax);
+  if (v <= -(64LL << kFracBit))
+    return Fix64::FromRaw(0);
+  return Fix64::FromRaw(ExpRaw(v * (1LL << (57 - kFracBit))));
+}
+
+Fix64 Log(const Fix64 &x) {
+  int64_t v = x.GetRaw();
+  if (v <= 0)
+    return Fix64::FromRaw(Fix64::kMin);
+  return Fix64::FromRaw(RoundShift(LnQ57(uint64_t(v)), 57 - kFracBit));
+}
+
+Fix64 Pow(const Fix64 &x, const Fix64 &y) {
+  int64_t xr = x.GetRaw(), yr = y.GetRaw();
+  if (yr == 0)
+    return Fix64::FromRaw(Fix64::kOne);
+  if (xr == 0)
+    return Fix64::FromRaw(yr > 0 ? 0 : Fix64::kMax);
+
+  bool negative = false;
+  if (xr < 0) {
+    // 负数只有整数次幂，奇数次幂为负
+    if (yr & (Fix64::kOne - 1))
+      return Fix64::FromRaw(0);
+    negative = ((yr >> kFracBit) & 1) != 0;
+  }
+
+  // x^y = e^(y ln|x|)；乘积饱和时 ExpRaw 给出 kMax 或 0
+  int64_t r = ExpRaw(fix64_detail::Mul<kFracBit>(yr, LnQ57(Magnitude(xr)), true));
+  return Fix64::FromRaw(negative ? -r : r);
+}
+
+} // namespace fix64_math
@@ -0,0 +1,43 @@
+// Fix64 上结果确定的初等函数
+// 只使用整数运算（编译期生成的查找表、短多项式和牛顿迭代），所以所有平台和编译器的结果逐位相同，
+// 不像 std::sin 再 FromDouble 那样依赖平台
+//
+// 和 long double 对比的误差，单位是最后一位（2^-24），见 fix64_accuracy 的输出：
+//   Sqrt                    正确舍入
+//   Sin / Cos / Atan2 / Log 最多 0.53 ulp
+//   Exp / Pow               0.5 ulp 加上小于 2^-52 的相对误差，只有结果大于约 2^28 时才看得出来
+// Sin 和 Cos 用 62 位的 1/(2 pi) 做角度归约：|x| 到 2^35 误差都小于 1 ulp，到 2^38 时约 3 ulp
+
+#pragma once
+
+#include <stdint.h>
+
+#include "Fix64.h"
+
+namespace fix64_math {
+
+// 原始值，四舍五入
+constexpr int64_t kPi = 52707179;
+constexpr int64_t kHalfPi = 26353589;
+constexpr int64_t kTwoPi = 105414357;
+constexpr int64_t kE = 45605201;
+constexpr int64_t kLn2 = 11629080;
+
+// x 为负数时返回 0
+Fix64 Sqrt(const Fix64 &x);
+
+Fix64 Sin(const Fix64 &x);
+Fix64 Cos(const Fix64 &x);
+void SinCos(const Fix64 &x, Fix64 *sin, Fix64 *cos);
+// (x, y) 的角度，范围 [-pi, pi]；Atan2(0, 0) 返回 0
+Fix64 Atan2(const Fix64 &y, const Fix64 &x);
+
+// 上溢时饱和到 kMax，x 小于约 -17.3 时舍入为 0
+Fix64 Exp(const Fix64 &x);
+// 自然对数，x <= 0 时返回 kMin
+Fix64 Log(const Fix64 &x);
+// x^y。Pow(x, 0) 为 1，Pow(0, y < 0) 返回 kMax；x 为负数时 y 必须是整数
+// （否则没有实数结果，返回 0）
+Fix64 Pow(const Fix64 &x, const Fix64 &y);
+
+} // namespace fix64_math
@@ -0,0 +1,187 @@
+#include "Fix64Vector.h"
+
+#include "Fix64Batch.h"
+
+namespace fix64_math {
+
+namespace {
+
+Fix64 *Data(std::vector<Fix64> &v) { return v.data(); }
+const Fix64 *Data(const std::vector<Fix64> &v) { return v.data(); }
+
+struct Fnv1a {
+  uint64_t hash = 14695981039346656037ULL;
+
+  void Mix(const Fix64 &v) {
+    uint64_t bits = uint64_t(v.GetRaw());
+    for (int i = 0; i < 8; ++i) {
+      hash ^= (bits >> (i * 8)) & 0xFF;
+      hash *= 1099511628211ULL;
+    }
+  }
+  void Mix(const Vec3 &v) {
+    Mix(v.x);
+    Mix(v.y);
+    Mix(v.z);
+  }
+  void Mix(const Quaternion &q) {
+    Mix(q.x);
+    Mix(q.y);
+    Mix(q.z);
+    Mix(q.w);
+  }
+  void Mix(const RigidBody &body) {
+    Mix(body.position);
+    Mix(body.velocity);
+    Mix(body.orientation);
+  }
+};
+
+} // namespace
+
+void ScaleAdd(const Vec3Array &a, const Fix64 &s, const Vec3Array &c, Vec3Array *out) {
+  size_t n = a.Size();
+  out->Resize(n);
+  fix64_batch::ScaleAdd(Data(a.x), s, Data(c.x), Data(out->x), n);
+  fix64_batch::ScaleAdd(Data(a.y), s, Data(c.y), Data(out->y), n);
+  fix64_batch::ScaleAdd(Data(a.z), s, Data(c.z), Data(out->z), n);
+}
+
+void Dot(const Vec3Array &a, const Vec3Array &b, std::vector<Fix64> *out) {
+  size_t n = a.Size();
+  out->resize(n);
+  fix64_batch::Mul(Data(a.x), Data(b.x), Data(*out), n);
+  fix64_batch::MulAdd(Data(a.y), Data(b.y), Data(*out), Data(*out), n);
+  fix64_batch::MulAdd(Data(a.z), Data(b.z), Data(*out), Data(*out), n);
+}
+
+namespace {
+
+// 和 Normalize(Quaternion) 相同：乘以 1 / 长度，长度为 0 时乘以 1 保持不变
+void NormalizeWith(QuaternionArray *q, std::vector<Fix64> *scale) {
+  size_t n = q->Size();
+  fix64_batch::Mul(Data(q->x), Data(q->x), Data(*scale), n);
+  fix64_batch::MulAdd(Data(q->y), Data(q->y), Data(*scale), Data(*scale), n);
+  fix64_batch::MulAdd(Data(q->z), Data(q->z), Data(*scale), Data(*scale), n);
+  fix64_batch::MulAdd(Data(q->w), Data(q->w), Data(*scale), Data(*scale), n);
+  for (Fix64 &s : *scale) {
+    Fix64 length = Sqrt(s);
+    s = length ? Fix64(1) / length : Fix64(1);
+  }
+  fix64_batch::Mul(Data(q->x), Data(*scale), Data(q->x), n);
+  fix64_batch::Mul(Data(q->y), Data(*scale), Data(q->y), n);
+  fix64_batch::Mul(Data(q->z), Data(*scale), Data(q->z), n);
+  fix64_batch::Mul(Data(q->w), Data(*scale), Data(q->w), n);
+}
+
+// 1 / sqrt(dot) 在 1 附近的一步牛顿迭代 (3 - dot) / 2：每步只偏离单位长度很少，误差是偏差的平方，
+// 而且下一步会再修正，不需要开方和除法
+Fix64 Renormalization(const Fix64 &dot) {
+  return Fix64::FromRaw(3 * Fix64::kHalf) - dot * Fix64::FromRaw(Fix64::kHalf);
+}
+
+} // namespace
+
+void Normalize(QuaternionArray *q) {
+  std::vector<Fix64> scale(q->Size());
+  NormalizeWith(q, &scale);
+}
+
+void Integrate(RigidBody *body, const Fix64 &dt) {
+  // dq/dt = (w, 0) * q / 2，w 是世界坐标系的角速度
+  const Vec3 &w = body->angularVelocity;
+  Quaternion spin = Quaternion{w.x, w.y, w.z, Fix64()} * body->orientation;
+  body->velocity = body->acceleration * dt + body->velocity;
+  body->position = body->velocity * dt + body->position;
+  Quaternion q = spin * (dt * Fix64::FromRaw(Fix64::kHalf)) + body->orientation;
+  body->orientation = q * Renormalization(Dot(q, q));
+}
+
+void RigidBodies::Resize(size_t n) {
+  position.Resize(n);
+  velocity.Resize(n);
+  acceleration.Resize(n);
+  orientation.Resize(n);
+  angularVelocity.Resize(n);
+}
+
+RigidBody RigidBodies::Get(size_t i) const {
+  return {position.Get(i), velocity.Get(i), acceleration.Get(i), orientation.Get(i), angularVelocity.Get(i)};
+}
+
+void RigidBodies::Set(size_t i, const RigidBody &body) {
+  position.Set(i, body.position);
+  velocity.Set(i, body.velocity);
+  acceleration.Set(i, body.acceleration);
+  orientation.Set(i, body.orientation);
+  angularVelocity.Set(i, body.angularVelocity);
+}
+
+// 和 Integrate(RigidBody *) 逐位相同：加减法在 2^64 上回绕，和的顺序不影响结果，
+// 每个乘积的两个操作数都和逐个计算时一样
+void Integrate(RigidBodies *bodies, const Fix64 &dt) {
+  size_t n = bodies->Size();
+  const Vec3Array &w = bodies->angularVelocity;
+  QuaternionArray &q = bodies->orientation;
+  QuaternionArray &spin = bodies->spin;
+  std::vector<Fix64> &temp = bodies->temp;
+  spin.Resize(n);
+  temp.resize(n);
+
+  // spin = (w, 0) * q，展开 Quaternion::operator* 里 w 分量为 0 的项
+  fix64_batch::Mul(Data(w.x), Data(q.w), Data(spin.x), n);
+  fix64_batch::MulAdd(Data(w.y), Data(q.z), Data(spin.x), Data(spin.x), n);
+  fix64_batch::Mul(Data(w.z), Data(q.y), Data(temp), n);
+  fix64_batch::Sub(Data(spin.x), Data(temp), Data(spin.x), n);
+
+  fix64_batch::Mul(Data(w.y), Data(q.w), Data(spin.y), n);
+  fix64_batch::MulAdd(Data(w.z), Data(q.x), Data(spin.y), Data(spin.y), n);
+  fix64_batch::Mul(Data(w.x), Data(q.z), Data(temp), n);
+  fix64_batch::Sub(Data(spin.y), Data(temp), Data(spin.y), n);
+
+  fix64_batch::Mul(Data(w.x), Data(q.y), Data(spin.z), n);
+  fix64_batch::MulAdd(Data(w.z), Data(q.w), Data(spin.z), Data(spin.z), n);
+  fix64_batch::Mul(Data(w.y), Data(q.x), Data(temp), n);
+  fix64_batch::Sub(Data(spin.z), Data(temp), Data(spin.z), n);
+
+  // spin.w 存的是 -spin.w：乘法对符号对称，后面乘 -dt / 2 结果相同
+  fix64_batch::Mul(Data(w.x), Data(q.x), Data(spin.w), n);
+  fix64_batch::MulAdd(Data(w.y), Data(q.y), Data(spin.w), Data(spin.w), n);
+  fix64_batch::MulAdd(Data(w.z), Data(q.z), Data(spin.w), Data(spin.w), n);
+
+  ScaleAdd(bodies->acceleration, dt, bodies->velocity, &bodies->velocity);
+  ScaleAdd(bodies->velocity, dt, bodies->position, &bodies->position);
+
+  Fix64 halfDt = dt * Fix64::FromRaw(Fix64::kHalf);
+  fix64_batch::ScaleAdd(Data(spin.x), halfDt, Data(q.x), Data(q.x), n);
+  fix64_batch::ScaleAdd(Data(spin.y), halfDt, Data(q.y), Data(q.y), n);
+  fix64_batch::ScaleAdd(Data(spin.z), halfDt, Data(q.z), Data(q.z), n);
+  fix64_batch::ScaleAdd(Data(spin.w), -halfDt, Data(q.w), Data(q.w), n);
+
+  fix64_batch::Mul(Data(q.x), Data(q.x), Data(temp), n);
+  fix64_batch::MulAdd(Data(q.y), Data(q.y), Data(temp), Data(temp), n);
+  fix64_batch::MulAdd(Data(q.z), Data(q.z), Data(temp), Data(temp), n);
+  fix64_batch::MulAdd(Data(q.w), Data(q.w), Data(temp), Data(temp), n);
+  for (Fix64 &s : temp)
+    s = Renormalization(s);
+  fix64_batch::Mul(Data(q.x), Data(temp), Data(q.x), n);
+  fix64_batch::Mul(Data(q.y), Data(temp), Data(q.y), n);
+  fix64_batch::Mul(Data(q.z), Data(temp), Data(q.z), n);
+  fix64_batch::Mul(Data(q.w), Data(temp), Data(q.w), n);
+}
+
+uint64_t Checksum(const RigidBody *bodies, size_t n) {
+  Fnv1a fnv;
+  for (size_t i = 0; i < n; ++i)
+    fnv.Mix(bodies[i]);
+  return fnv.hash;
+}
+
+uint64_t Checksum(const RigidBodies &bodies) {
+  Fnv1a fnv;
+  for (size_t i = 0; i < bodies.Size(); ++i)
+    fnv.Mix(bodies.Get(i));
+  return fnv.hash;
+}
+
+} // namespace fix64_math
@@ -0,0 +1,318 @@
+// 帧同步模拟使用的 Fix64 向量运算，结果确定
+// Vec2 / Vec3 / Vec4 / Quaternion / Mat4 都是普通的值类型，所有运算都由 Fix64 的运算符和
+// fix64_math::Sqrt / SinCos 组成，所以所有平台的结果逐位相同。
+// 乘积和 Fix64 一样溢出时回绕，所以 Dot 和 Length 要求分量的绝对值小于约 2^19
+//
+// Vec3Array / QuaternionArray 把每个分量放在单独的数组里（SoA），给 Fix64Batch 的批量运算使用。
+// RigidBodies 用这种方式积分一批刚体，结果和对每个刚体调用 Integrate(RigidBody *) 逐位相同
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "Fix64.h"
+#include "Fix64Math.h"
+
+namespace fix64_math {
+
+struct Vec2 {
+  Fix64 x, y;
+};
+
+struct Vec3 {
+  Fix64 x, y, z;
+};
+
+struct Vec4 {
+  Fix64 x, y, z, w;
+};
+
+// x, y, z 是向量部分，w 是标量部分；旋转使用单位四元数
+struct Quaternion {
+  Fix64 x, y, z, w;
+
+  static constexpr Quaternion Identity() { return {Fix64(), Fix64(), Fix64(), Fix64(1)}; }
+};
+
+// m[行][列]，向量是列向量：Transform(a * b, v) == Transform(a, Transform(b, v))
+struct Mat4 {
+  Fix64 m[4][4];
+
+  static constexpr Mat4 Identity() {
+    Mat4 r{};
+    for (int i = 0; i < 4; ++i)
+      r.m[i][i] = Fix64(1);
+    return r;
+  }
+};
+
+// ---- Vec2 ----
+
+constexpr Vec2 operator+(const Vec2 &a, const Vec2 &b) { return {a.x + b.x, a.y + b.y}; }
+constexpr Vec2 operator-(const Vec2 &a, const Vec2 &b) { return {a.x - b.x, a.y - b.y}; }
+constexpr Vec2 operator-(const Vec2 &a) { return {-a.x, -a.y}; }
+constexpr Vec2 operator*(const Vec2 &a, const Fix64 &s) { return {a.x * s, a.y * s}; }
+constexpr Vec2 operator/(const Vec2 &a, const Fix64 &s) { return {a.x / s, a.y / s}; }
+constexpr bool operator==(const Vec2 &a, const Vec2 &b) { return a.x == b.x && a.y == b.y; }
+constexpr bool operator!=(const Vec2 &a, const Vec2 &b) { return !(a == b); }
+
+constexpr Fix64 Dot(const Vec2 &a, const Vec2 &b) { return a.x * b.x + a.y * b.y; }
+// 三维叉积的 z 分量，b 在 a 的逆时针方向时为正
+constexpr Fix64 Cross(const Vec2 &a, const Vec2 &b) { return a.x * b.y - a.y * b.x; }
+
+// ---- Vec3 ----
+
+constexpr Vec3 operator+(const Vec3 &a, const Vec3 &b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+constexpr Vec3 operator-(const Vec3 &a, const Vec3 &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+constexpr Vec3 operator-(const Vec3 &a) { return {-a.x, -a.y, -a.z}; }
+constexpr Vec3 operator*(const Vec3 &a, const Fix64 &s) { return {a.x * s, a.y * s, a.z * s}; }
+constexpr Vec3 operator/(const Vec3 &a, const Fix64 &s) { return {a.x / s, a.y / s, a.z / s}; }
+constexpr bool operator==(const Vec3 &a, const Vec3 &b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+constexpr bool operator!=(const Vec3 &a, const Vec3 &b) { return !(a == b); }
+
+constexpr Fix64 Dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr Vec3 Cross(const Vec3 &a, const Vec3 &b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// ---- Vec4 ----
+
+constexpr Vec4 operator+(const Vec4 &a, const Vec4 &b) { return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}; }
+constexpr Vec4 operator-(const Vec4 &a, const Vec4 &b) { return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}; }
+constexpr Vec4 operator-(const Vec4 &a) { return {-a.x, -a.y, -a.z, -a.w}; }
+constexpr Vec4 operator*(const Vec4 &a, const Fix64 &s) { return {a.x * s, a.y * s, a.z * s, a.w * s}; }
+constexpr Vec4 operator/(const Vec4 &a, const Fix64 &s) { return {a.x / s, a.y / s, a.z / s, a.w / s}; }
+constexpr bool operator==(const Vec4 &a, const Vec4 &b) {
+  return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+constexpr bool operator!=(const Vec4 &a, const Vec4 &b) { return !(a == b); }
+
+constexpr Fix64 Dot(const Vec4 &a, const Vec4 &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// ---- Quaternion ----
+
+// Hamilton 乘积：按 a * b 旋转就是先按 b 旋转，再按 a 旋转
+constexpr Quaternion operator*(const Quaternion &a, const Quaternion &b) {
+  return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+          a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+constexpr Quaternion operator*(const Quaternion &q, const Fix64 &s) { return {q.x * s, q.y * s, q.z * s, q.w * s}; }
+constexpr Quaternion operator/(const Quaternion &q, const Fix64 &s) { return {q.x / s, q.y / s, q.z / s, q.w / s}; }
+constexpr Quaternion operator+(const Quaternion &a, const Quaternion &b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+constexpr bool operator==(const Quaternion &a, const Quaternion &b) {
+  return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+constexpr bool operator!=(const Quaternion &a, const Quaternion &b) { return !(a == b); }
+
+constexpr Fix64 Dot(const Quaternion &a, const Quaternion &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+// 单位四元数的逆
+constexpr Quaternion Conjugate(const Quaternion &q) { return {-q.x, -q.y, -q.z, q.w}; }
+
+// 绕单位向量 axis 旋转 angle（弧度）
+inline Quaternion FromAxisAngle(const Vec3 &axis, const Fix64 &angle) {
+  Fix64 s, c;
+  SinCos(angle * Fix64::FromRaw(Fix64::kHalf), &s, &c);
+  return {axis.x * s, axis.y * s, axis.z * s, c};
+}
+
+// 用单位四元数 q 旋转 v：v + w t + u x t，其中 u = (x, y, z)，t = 2 u x v
+constexpr Vec3 Rotate(const Quaternion &q, const Vec3 &v) {
+  Vec3 u = {q.x, q.y, q.z};
+  Vec3 t = Cross(u, v);
+  t = t + t;
+  return v + t * q.w + Cross(u, t);
+}
+
+// ---- Length 和 Normalize：v / Length(v)，零向量保持为零 ----
+
+inline Fix64 Length(const Vec2 &v) { return Sqrt(Dot(v, v)); }
+inline Fix64 Length(const Vec3 &v) { return Sqrt(Dot(v, v)); }
+inline Fix64 Length(const Vec4 &v) { return Sqrt(Dot(v, v)); }
+inline Fix64 Length(const Quaternion &q) { return Sqrt(Dot(q, q)); }
+
+inline Vec2 Normalize(const Vec2 &v) {
+  Fix64 length = Length(v);
+  return length ? v / length : v;
+}
+inline Vec3 Normalize(const Vec3 &v) {
+  Fix64 length = Length(v);
+  return length ? v / length : v;
+}
+inline Vec4 Normalize(const Vec4 &v) {
+  Fix64 length = Length(v);
+  return length ? v / length : v;
+}
+// 四元数的长度总是接近 1，所以一次除法加四次乘法不损失精度
+inline Quaternion Normalize(const Quaternion &q) {
+  Fix64 length = Length(q);
+  return length ? q * (Fix64(1) / length) : q;
+}
+
+// ---- Mat4 ----
+
+constexpr Mat4 operator*(const Mat4 &a, const Mat4 &b) {
+  Mat4 r{};
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+  return r;
+}
+
+constexpr bool operator==(const Mat4 &a, const Mat4 &b) {
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      if (a.m[i][j] != b.m[i][j])
+        return false;
+  return true;
+}
+constexpr bool operator!=(const Mat4 &a, const Mat4 &b) { return !(a == b); }
+
+constexpr Mat4 Transpose(const Mat4 &a) {
+  Mat4 r{};
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      r.m[i][j] = a.m[j][i];
+  return r;
+}
+
+constexpr Mat4 Translation(const Vec3 &t) {
+  Mat4 r = Mat4::Identity();
+  r.m[0][3] = t.x;
+  r.m[1][3] = t.y;
+  r.m[2][3] = t.z;
+  return r;
+}
+
+constexpr Mat4 Scaling(const Vec3 &s) {
+  Mat4 r = Mat4::Identity();
+  r.m[0][0] = s.x;
+  r.m[1][1] = s.y;
+  r.m[2][2] = s.z;
+  return r;
+}
+
+// 单位四元数对应的旋转矩阵
+constexpr Mat4 Rotation(const Quaternion &q) {
+  Fix64 one = Fix64(1);
+  Fix64 x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+  Fix64 xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+  Fix64 xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+  Fix64 wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+  Mat4 r = Mat4::Identity();
+  r.m[0][0] = one - (yy + zz);
+  r.m[0][1] = xy - wz;
+  r.m[0][2] = xz + wy;
+  r.m[1][0] = xy + wz;
+  r.m[1][1] = one - (xx + zz);
+  r.m[1][2] = yz - wx;
+  r.m[2][0] = xz - wy;
+  r.m[2][1] = yz + wx;
+  r.m[2][2] = one - (xx + yy);
+  return r;
+}
+
+constexpr Vec4 Transform(const Mat4 &a, const Vec4 &v) {
+  Fix64 r[4];
+  for (int i = 0; i < 4; ++i)
+    r[i] = a.m[i][0] * v.x + a.m[i][1] * v.y + a.m[i][2] * v.z + a.m[i][3] * v.w;
+  return {r[0], r[1], r[2], r[3]};
+}
+
+// w = 1：旋转、缩放和平移，不做透视除法
+constexpr Vec3 TransformPoint(const Mat4 &a, const Vec3 &p) {
+  Vec4 r = Transform(a, {p.x, p.y, p.z, Fix64(1)});
+  return {r.x, r.y, r.z};
+}
+
+// w = 0：方向不受平移影响
+constexpr Vec3 TransformVector(const Mat4 &a, const Vec3 &v) {
+  Vec4 r = Transform(a, {v.x, v.y, v.z, Fix64()});
+  return {r.x, r.y, r.z};
+}
+
+// ---- SoA ----
+
+struct Vec3Array {
+  std::vector<Fix64> x, y, z;
+
+  size_t Size() const { return x.size(); }
+  void Resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+  }
+  Vec3 Get(size_t i) const { return {x[i], y[i], z[i]}; }
+  void Set(size_t i, const Vec3 &v) {
+    x[i] = v.x;
+    y[i] = v.y;
+    z[i] = v.z;
+  }
+};
+
+struct QuaternionArray {
+  std::vector<Fix64> x, y, z, w;
+
+  size_t Size() const { return x.size(); }
+  void Resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    w.resize(n);
+  }
+  Quaternion Get(size_t i) const { return {x[i], y[i], z[i], w[i]}; }
+  void Set(size_t i, const Quaternion &q) {
+    x[i] = q.x;
+    y[i] = q.y;
+    z[i] = q.z;
+    w[i] = q.w;
+  }
+};
+
+// out = a * s + c，逐个分量计算
+void ScaleAdd(const Vec3Array &a, const Fix64 &s, const Vec3Array &c, Vec3Array *out);
+// out[i] = Dot(a[i], b[i])
+void Dot(const Vec3Array &a, const Vec3Array &b, std::vector<Fix64> *out);
+// 每个元素和 Normalize(q) 相同
+void Normalize(QuaternionArray *q);
+
+// ---- 刚体积分（半隐式欧拉） ----
+// 朝向用一步牛顿迭代 q * (3 - Dot(q, q)) / 2 保持单位长度，而不是 Normalize：
+// 每步的偏差很小，而且不需要开方和除法，所以批量版本全部在 SIMD kernel 里执行
+
+// angularVelocity 是世界坐标系的角速度，单位是弧度每秒
+struct RigidBody {
+  Vec3 position, velocity, acceleration;
+  Quaternion orientation;
+  Vec3 angularVelocity;
+};
+
+void Integrate(RigidBody *body, const Fix64 &dt);
+
+struct RigidBodies {
+  Vec3Array position, velocity, acceleration;
+  QuaternionArray orientation;
+  Vec3Array angularVelocity;
+
+  size_t Size() const { return position.Size(); }
+  void Resize(size_t n);
+  RigidBody Get(size_t i) const;
+  void Set(size_t i, const RigidBody &body);
+
+  // Integrate 的临时数组，保留下来避免每步分配
+  QuaternionArray spin;
+  std::vector<Fix64> temp;
+};
+
+void Integrate(RigidBodies *bodies, const Fix64 &dt);
+
+// 逐个刚体对 position、velocity 和 orientation 计算 FNV-1a；两种布局的结果相同
+uint64_t Checksum(const RigidBody *bodies, size_t n);
+uint64_t Checksum(const RigidBodies &bodies);
+
+} // namespace fix64_math
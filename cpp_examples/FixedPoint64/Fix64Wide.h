@@ -0,0 +1,213 @@
+// 128 位中间结果的定点数乘除法，64 位 FixedPoint（包括 Fix64）的 operator* / operator/ 使用
+// 两个后端，结果逐位相同:
+//   Int128   GCC/Clang 的 unsigned __int128，乘法是一条 64x64->128 的乘法指令
+//   Portable 不依赖编译器扩展和 intrinsic：32 位分块的乘法，Hacker's Delight 的 128/64 除法
+// 编译器不支持 __int128（例如 MSVC）或者定义了 FIX64_NO_INT128 时使用 Portable
+//
+// 舍入：取最近的值，正好一半时远离 0，所以 (-a) * b == -(a * b)
+// 溢出：saturate 为 false 时取结果的低 64 位（和整数运算一样回绕），为 true 时饱和到 INT64_MIN / INT64_MAX
+// 除零：按被除数的符号返回 INT64_MAX / INT64_MIN，0 / 0 返回 0
+// 所有函数都是 constexpr：FixedPoint 的运算可以在编译期求值，Fix64Math 用 Portable 的函数生成查找表
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__SIZEOF_INT128__) && !defined(FIX64_NO_INT128)
+#define FIX64_HAS_INT128 1
+#endif
+
+// 乘法只有几条指令，saturate 通常是常量，所以强制内联：很大的编译单元里 GCC 可能放弃内联，
+// 改为调用 saturate 是变量的通用版本，反而比不内联的 operator* 还慢
+#if defined(__GNUC__)
+#define FIX64_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FIX64_ALWAYS_INLINE __forceinline
+#else
+#define FIX64_ALWAYS_INLINE inline
+#endif
+
+namespace fix64_detail {
+
+struct U128 {
+  uint64_t hi;
+  uint64_t lo;
+};
+
+// 有符号数的绝对值，INT64_MIN 也能正确表示
+// 用掩码而不是条件表达式：内联进循环以后 GCC 会把条件表达式编译成分支，符号随机时经常预测失败
+constexpr uint64_t Magnitude(int64_t v) {
+  uint64_t mask = 0 - static_cast<uint64_t>(v < 0);
+  return (static_cast<uint64_t>(v) ^ mask) - mask;
+}
+
+// 把符号和 128 位的绝对值合成结果，处理溢出
+constexpr int64_t Finish(bool negative, U128 q, bool saturate) {
+  if (saturate) {
+    uint64_t limit = negative ? (1ULL << 63) : (1ULL << 63) - 1;
+    if (q.hi != 0 || q.lo > limit)
+      return negative ? INT64_MIN : INT64_MAX;
+  }
+  uint64_t mask = 0 - static_cast<uint64_t>(negative);
+  return static_cast<int64_t>((q.lo ^ mask) - mask);
+}
+
+constexpr int64_t DivideByZero(int64_t a) {
+  return a > 0 ? INT64_MAX : (a < 0 ? INT64_MIN : 0);
+}
+
+// ---- Portable ----
+
+constexpr U128 MulU64(uint64_t a, uint64_t b) {
+  uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32;
+  uint64_t b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+  uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+  U128 r = {0, 0};
+  r.lo = (mid << 32) | (p00 & 0xFFFFFFFF);
+  r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return r;
+}
+
+constexpr U128 AddU64(U128 a, uint64_t b) {
+  U128 r = {0, 0};
+  r.lo = a.lo + b;
+  r.hi = a.hi + (r.lo < b ? 1 : 0);
+  return r;
+}
+
+// 0 < shift < 64
+constexpr U128 ShiftRight(U128 a, int shift) {
+  U128 r = {0, 0};
+  r.lo = (a.lo >> shift) | (a.hi << (64 - shift));
+  r.hi = a.hi >> shift;
+  return r;
+}
+
+constexpr int CountLeadingZeros(uint64_t x) {
+  int n = 0;
+  if (x <= 0x00000000FFFFFFFF) { n += 32; x <<= 32; }
+  if (x <= 0x0000FFFFFFFFFFFF) { n += 16; x <<= 16; }
+  if (x <= 0x00FFFFFFFFFFFFFF) { n += 8; x <<= 8; }
+  if (x <= 0x0FFFFFFFFFFFFFFF) { n += 4; x <<= 4; }
+  if (x <= 0x3FFFFFFFFFFFFFFF) { n += 2; x <<= 2; }
+  if (x <= 0x7FFFFFFFFFFFFFFF) { n += 1; }
+  return n;
+}
+
+// (u1:u0) / v，要求 u1 < v（商不超过 64 位）
+// Hacker's Delight 2nd edition, divlu：除数规格化以后按 32 位一位地估商
+constexpr uint64_t DivU128By64(uint64_t u1, uint64_t u0, uint64_t v, uint64_t *rem) {
+  const uint64_t b = 1ULL << 32;
+  int s = CountLeadingZeros(v);
+  v <<= s;
+  uint64_t vn1 = v >> 32, vn0 = v & 0xFFFFFFFF;
+  uint64_t un32 = (u1 << s) | (s == 0 ? 0 : u0 >> (64 - s));
+  uint64_t un10 = u0 << s;
+  uint64_t un1 = un10 >> 32, un0 = un10 & 0xFFFFFFFF;
+
+  uint64_t q1 = un32 / vn1;
+  uint64_t rhat = un32 - q1 * vn1;
+  while (q1 >= b || q1 * vn0 > b * rhat + un1) {
+    --q1;
+    rhat += vn1;
+    if (rhat >= b)
+      break;
+  }
+  uint64_t un21 = un32 * b + un1 - q1 * v;
+
+  uint64_t q0 = un21 / vn1;
+  rhat = un21 - q0 * vn1;
+  while (q0 >= b || q0 * vn0 > b * rhat + un0) {
+    --q0;
+    rhat += vn1;
+    if (rhat >= b)
+      break;
+  }
+  *rem = (un21 * b + un0 - q0 * v) >> s;
+  return q1 * b + q0;
+}
+
+template <int FracBits>
+constexpr int64_t MulPortable(int64_t a, int64_t b, bool saturate) {
+  static_assert(FracBits > 0 && FracBits < 64, "FracBits must be in (0, 64)");
+  bool negative = (a < 0) != (b < 0);
+  U128 p = MulU64(Magnitude(a), Magnitude(b));
+  p = AddU64(p, 1ULL << (FracBits - 1));
+  return Finish(negative, ShiftRight(p, FracBits), saturate);
+}
+
+template <int FracBits>
+constexpr int64_t DivPortable(int64_t a, int64_t b, bool saturate) {
+  static_assert(FracBits > 0 && FracBits < 64, "FracBits must be in (0, 64)");
+  if (b == 0)
+    return DivideByZero(a);
+  bool negative = (a < 0) != (b < 0);
+  uint64_t ua = Magnitude(a), d = Magnitude(b);
+  uint64_t nhi = ua >> (64 - FracBits), nlo = ua << FracBits;
+  U128 q = {0, 0};
+  uint64_t r = 0;
+  q.hi = nhi / d;
+  q.lo = DivU128By64(nhi % d, nlo, d, &r);
+  // 余数不小于除数的一半时进位，r >= d - r 不会溢出
+  if (r >= d - r) {
+    q.lo += 1;
+    q.hi += (q.lo == 0 ? 1 : 0);
+  }
+  return Finish(negative, q, saturate);
+}
+
+// ---- Int128 ----
+
+#ifdef FIX64_HAS_INT128
+__extension__ typedef unsigned __int128 uint128_t;
+
+constexpr U128 Split(uint128_t v) {
+  U128 r = {0, 0};
+  r.hi = static_cast<uint64_t>(v >> 64);
+  r.lo = static_cast<uint64_t>(v);
+  return r;
+}
+
+template <int FracBits>
+FIX64_ALWAYS_INLINE constexpr int64_t MulInt128(int64_t a, int64_t b, bool saturate) {
+  bool negative = (a < 0) != (b < 0);
+  uint128_t p = static_cast<uint128_t>(Magnitude(a)) * Magnitude(b);
+  p += uint128_t(1) << (FracBits - 1);
+  return Finish(negative, Split(p >> FracBits), saturate);
+}
+
+template <int FracBits>
+constexpr int64_t DivInt128(int64_t a, int64_t b, bool saturate) {
+  if (b == 0)
+    return DivideByZero(a);
+  bool negative = (a < 0) != (b < 0);
+  uint64_t d = Magnitude(b);
+  uint128_t n = static_cast<uint128_t>(Magnitude(a)) << FracBits;
+  uint128_t q = n / d;
+  uint64_t r = static_cast<uint64_t>(n - q * d);
+  if (r >= d - r)
+    q += 1;
+  return Finish(negative, Split(q), saturate);
+}
+#endif
+
+template <int FracBits>
+FIX64_ALWAYS_INLINE constexpr int64_t Mul(int64_t a, int64_t b, bool saturate) {
+#ifdef FIX64_HAS_INT128
+  return MulInt128<FracBits>(a, b, saturate);
+#else
+  return MulPortable<FracBits>(a, b, saturate);
+#endif
+}
+
+template <int FracBits>
+constexpr int64_t Div(int64_t a, int64_t b, bool saturate) {
+#ifdef FIX64_HAS_INT128
+  return DivInt128<FracBits>(a, b, saturate);
+#else
+  return DivPortable<FracBits>(a, b, saturate);
+#endif
+}
+
+} // namespace fix64_detail
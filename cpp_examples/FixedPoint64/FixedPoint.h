@@ -0,0 +1,197 @@
+// 定点数模板：IntBits 位整数（含符号位）和 FracBits 位小数，存在有符号整数 Storage 里
+// 所有运算都在头文件里并且是 constexpr，可以内联，也可以在编译期求值
+// 常用的格式：
+//   Q16_16  FixedPoint<16, 16, int32_t>
+//   Fix64   FixedPoint<40, 24, int64_t>，见 Fix64.h
+//   Q32_32  FixedPoint<32, 32, int64_t>
+// 舍入、溢出和除零的规则对所有格式都一样，见 Fix64Wide.h
+
+#pragma once
+
+#include <stdint.h>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "Fix64Wide.h"
+
+namespace fixed_point_detail {
+
+// 每种 Storage 的乘除法
+template <typename Storage>
+struct Arithmetic;
+
+// 64 位：128 位的中间结果，见 Fix64Wide.h
+template <>
+struct Arithmetic<int64_t> {
+  template <int FracBits>
+  FIX64_ALWAYS_INLINE static constexpr int64_t Mul(int64_t a, int64_t b, bool saturate) {
+    return fix64_detail::Mul<FracBits>(a, b, saturate);
+  }
+  template <int FracBits>
+  static constexpr int64_t Div(int64_t a, int64_t b, bool saturate) {
+    return fix64_detail::Div<FracBits>(a, b, saturate);
+  }
+};
+
+// 32 位：64 位的中间结果就够了，规则和 Fix64Wide.h 相同
+template <>
+struct Arithmetic<int32_t> {
+  static constexpr uint64_t Magnitude(int32_t v) { return v < 0 ? 0 - uint64_t(int64_t(v)) : uint64_t(v); }
+
+  static constexpr int32_t Finish(bool negative, uint64_t q, bool saturate) {
+    if (saturate) {
+      uint64_t limit = negative ? (1ULL << 31) : (1ULL << 31) - 1;
+      if (q > limit)
+        return negative ? INT32_MIN : INT32_MAX;
+    }
+    uint32_t bits = uint32_t(q);
+    return int32_t(negative ? 0 - bits : bits);
+  }
+
+  template <int FracBits>
+  FIX64_ALWAYS_INLINE static constexpr int32_t Mul(int32_t a, int32_t b, bool saturate) {
+    bool negative = (a < 0) != (b < 0);
+    uint64_t p = Magnitude(a) * Magnitude(b) + (1ULL << (FracBits - 1));
+    return Finish(negative, p >> FracBits, saturate);
+  }
+
+  template <int FracBits>
+  static constexpr int32_t Div(int32_t a, int32_t b, bool saturate) {
+    if (b == 0)
+      return a > 0 ? INT32_MAX : (a < 0 ? INT32_MIN : 0);
+    bool negative = (a < 0) != (b < 0);
+    uint64_t d = Magnitude(b);
+    uint64_t n = Magnitude(a) << FracBits;
+    uint64_t q = n / d, r = n % d;
+    if (r >= d - r)
+      q += 1;
+    return Finish(negative, q, saturate);
+  }
+};
+
+} // namespace fixed_point_detail
+
+template <int IntBits, int FracBits, typename Storage>
+class FixedPoint {
+  static_assert(std::is_same<Storage, int32_t>::value || std::is_same<Storage, int64_t>::value,
+                "Storage must be int32_t or int64_t");
+  static_assert(IntBits + FracBits == int(sizeof(Storage) * 8), "IntBits + FracBits must fill Storage");
+  static_assert(IntBits >= 2 && FracBits >= 1, "need a sign bit, an integer bit and a fraction bit");
+
+  typedef typename std::make_unsigned<Storage>::type Unsigned;
+  typedef fixed_point_detail::Arithmetic<Storage> Arithmetic;
+
+private:
+  Storage mRawValue = 0;
+
+  // 加减法用无符号数回绕，避免有符号溢出
+  static constexpr Storage Wrap(Unsigned v) { return Storage(v); }
+
+public:
+  constexpr FixedPoint() {}
+  // 整数值，超出范围时回绕
+  explicit constexpr FixedPoint(int64_t val) : mRawValue(Storage(uint64_t(val) << FracBits)) {}
+
+  // constants
+  static constexpr Storage kMin = std::numeric_limits<Storage>::min();
+  static constexpr Storage kPosMin = 1;
+  static constexpr Storage kMax = std::numeric_limits<Storage>::max(); // 0_ 11111.....
+  static constexpr Storage kOne = Storage(1) << FracBits;
+  static constexpr Storage kHalf = Storage(1) << (FracBits - 1);
+  static constexpr double kDelta = 1.0 / kOne;
+
+  // cast
+  static constexpr FixedPoint FromRaw(Storage val) {
+    FixedPoint f;
+    f.mRawValue = val;
+    return f;
+  }
+  // 截断到 0
+  static constexpr FixedPoint FromFloat(float val) { return FromRaw(Storage(val * (float)kOne)); }
+  static constexpr FixedPoint FromDouble(double val) { return FromRaw(Storage(val * (double)kOne)); }
+  // 四舍五入到整数
+  explicit constexpr operator int64_t() const { return (int64_t(mRawValue) + kHalf) >> FracBits; }
+  explicit constexpr operator float() const { return (float)mRawValue / kOne; }
+  explicit constexpr operator double() const { return (double)mRawValue / kOne; }
+  constexpr operator bool() const { return mRawValue != 0; }
+
+  // compare
+  // 内部的raw_value用有符号数的好处就是避免处理正负号的判断
+  constexpr bool operator==(const FixedPoint &other) const { return mRawValue == other.mRawValue; }
+  constexpr bool operator!=(const FixedPoint &other) const { return mRawValue != other.mRawValue; }
+  constexpr bool operator>(const FixedPoint &other) const { return mRawValue > other.mRawValue; }
+  constexpr bool operator<(const FixedPoint &other) const { return mRawValue < other.mRawValue; }
+  constexpr bool operator>=(const FixedPoint &other) const { return mRawValue >= other.mRawValue; }
+  constexpr bool operator<=(const FixedPoint &other) const { return mRawValue <= other.mRawValue; }
+
+  // unary
+  // -kMin 回绕成 kMin
+  constexpr FixedPoint operator-() const { return FromRaw(Wrap(0 - Unsigned(mRawValue))); }
+  constexpr bool operator!() const { return mRawValue == 0; }
+
+  // members
+  constexpr int Sign() const { return mRawValue == 0 ? 0 : (mRawValue > 0 ? 1 : -1); }
+  // return kMax at abs(kMin)
+  constexpr FixedPoint Abs() const { return mRawValue == kMin ? FromRaw(kMax) : FastAbs(); }
+  // return kMin at abs(kMin)
+  constexpr FixedPoint FastAbs() const {
+    Storage mask = mRawValue >> (sizeof(Storage) * 8 - 1);
+    return FromRaw(Wrap((Unsigned(mRawValue) + Unsigned(mask)) ^ Unsigned(mask)));
+  }
+
+  // binary
+  constexpr FixedPoint operator+(const FixedPoint &other) const {
+    return FromRaw(Wrap(Unsigned(mRawValue) + Unsigned(other.mRawValue)));
+  }
+  constexpr FixedPoint SafeAdd(const FixedPoint &other) const {
+    Storage x = mRawValue, y = other.mRawValue;
+    if (y > 0 && x > kMax - y)
+      return FromRaw(kMax);
+    if (y < 0 && x < kMin - y)
+      return FromRaw(kMin);
+    return FromRaw(x + y);
+  }
+  constexpr FixedPoint operator-(const FixedPoint &other) const {
+    return FromRaw(Wrap(Unsigned(mRawValue) - Unsigned(other.mRawValue)));
+  }
+  constexpr FixedPoint SafeMinus(const FixedPoint &other) const {
+    Storage x = mRawValue, y = other.mRawValue;
+    if (y > 0 && x < kMin + y)
+      return FromRaw(kMin);
+    if (y < 0 && x > kMax + y)
+      return FromRaw(kMax);
+    return FromRaw(x - y);
+  }
+  // rounded to nearest (ties away from zero), wrap on overflow,
+  // x / 0 gives kMax or kMin by the sign of x (0 / 0 gives 0)
+  FIX64_ALWAYS_INLINE constexpr FixedPoint operator*(const FixedPoint &other) const {
+    // 定点数可以表示为 2^{-n} * F
+    // A * B = (2^{-n} * A) * (2^{-n} * B) = 2^{-n} ( A * B * 2^{-n})，括号内的既是需要计算的值
+    // A * B 需要两倍宽度的中间结果
+    return FromRaw(Arithmetic::template Mul<FracBits>(mRawValue, other.mRawValue, false));
+  }
+  constexpr FixedPoint operator/(const FixedPoint &other) const {
+    // (A << n) / B，同样需要两倍宽度的被除数
+    return FromRaw(Arithmetic::template Div<FracBits>(mRawValue, other.mRawValue, false));
+  }
+  // saturate to kMin/kMax on overflow
+  FIX64_ALWAYS_INLINE constexpr FixedPoint SafeMul(const FixedPoint &other) const {
+    return FromRaw(Arithmetic::template Mul<FracBits>(mRawValue, other.mRawValue, true));
+  }
+  constexpr FixedPoint SafeDiv(const FixedPoint &other) const {
+    return FromRaw(Arithmetic::template Div<FracBits>(mRawValue, other.mRawValue, true));
+  }
+
+  // for debug
+  constexpr Storage GetRaw() const { return mRawValue; }
+  std::string GetDesc() const {
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "Fixed(%lld, %g)", (long long)mRawValue, (double)(*this));
+    return {tmp};
+  }
+};
+
+typedef FixedPoint<16, 16, int32_t> Q16_16;
+typedef FixedPoint<32, 32, int64_t> Q32_32;
@@ -12,7 +12,7 @@
 %include "std_string.i"
 %include "typemaps.i"
 
-%rename(Fix64_FromInt64) Fix64(int64_t);
+%rename(Fix64_FromInt64) FixedPoint::FixedPoint(int64_t);
 %rename(toFloat) operator float() const;
 %rename(toInt64) operator int64_t() const;
 %rename(toDouble) operator double() const;
@@ -21,14 +21,16 @@
     #include "Fix64.h"
 %}
 
+%include <FixedPoint.h>
 %include <Fix64.h>
+%template(Fix64) FixedPoint<kIntegerBit, kFracBit, int64_t>;
 
 
-%extend Fix64{
+%extend FixedPoint<kIntegerBit, kFracBit, int64_t>{
   std::string __repr__() {
     return $self->GetDesc();
   }
-  Fix64 __abs__() {
+  FixedPoint<kIntegerBit, kFracBit, int64_t> __abs__() {
     return $self->Abs();
   }
 };
\ No newline at end of file
@@ -114,16 +114,49 @@ class TestBasicFix64(unittest.TestCase):
             self.assertAlmostEqual(Fix64.Fix64_FromDouble(a[i]) * Fix64.Fix64_FromDouble(b[i]),
                                    Fix64.Fix64_FromDouble(c[i]), None, None, Fix64.Fix64_FromFloat(0.005))
 
+    @staticmethod
+    def div_raw(a, b):
+        # raw quotient of operator/: rounded to nearest, ties away from zero
+        q, r = divmod(abs(a) << Fix64.kFracBit, abs(b))
+        if 2 * r >= abs(b):
+            q += 1
+        return q if (a < 0) == (b < 0) else -q
+
     def test_div(self):
         n = 1000
         a = [random.randrange(-10000, 10000) for _ in range(n)]
         b = [random.randrange(1, 10000) for _ in range(n//2)]
         b.extend([random.randrange(-10000, -1) for _ in range(n//2)])
 
-        c = [(a[i] / b[i]) for i in range(n)]
         for i in range(n):
-            self.assertAlmostEqual(Fix64.Fix64_FromInt64(a[i]) / Fix64.Fix64_FromInt64(b[i]),
-                                   Fix64.Fix64_FromDouble(c[i]))
+            fa = Fix64.Fix64_FromInt64(a[i])
+            fb = Fix64.Fix64_FromInt64(b[i])
+            c = Fix64.Fix64_FromRaw(self.div_raw(fa.GetRaw(), fb.GetRaw()))
+            self.assertEqual(fa / fb, c)
+            self.assertEqual(fa.SafeDiv(fb), c)
+
+        # 2 / 3 rounds up, FromDouble would truncate
+        self.assertEqual((Fix64.Fix64_FromInt64(2) / Fix64.Fix64_FromInt64(3)).GetRaw(), 11184811)
+
+    def test_saturate(self):
+        fix64_max = Fix64.Fix64_FromRaw(Fix64.Fix64.kMax)
+        fix64_min = Fix64.Fix64_FromRaw(Fix64.Fix64.kMin)
+        big = Fix64.Fix64_FromInt64(1 << 30)
+        delta = Fix64.Fix64_FromRaw(1)
+        zero = Fix64.Fix64()
+
+        self.assertEqual(big.SafeMul(big), fix64_max)
+        self.assertEqual((-big).SafeMul(big), fix64_min)
+        self.assertNotEqual(big * big, fix64_max)
+        self.assertEqual(big.SafeDiv(delta), fix64_max)
+        self.assertEqual((-big).SafeDiv(delta), fix64_min)
+
+        # x / 0 gives kMax or kMin by the sign of x, 0 / 0 gives 0
+        one = Fix64.Fix64_FromInt64(1)
+        self.assertEqual(one.SafeDiv(zero), fix64_max)
+        self.assertEqual((-one).SafeDiv(zero), fix64_min)
+        self.assertEqual(one / zero, fix64_max)
+        self.assertEqual(zero / zero, zero)
 
     def test_abs(self):
         min_fix = Fix64.Fix64_FromRaw(Fix64.Fix64.kMin)
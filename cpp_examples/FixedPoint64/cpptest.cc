@@ -1,9 +1,458 @@
 #include <Fix64.h>
+#include <Fix64Batch.h>
+#include <Fix64Math.h>
+#include <Fix64Vector.h>
+#include <Fix64Wide.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+template <typename T>
+static void Check(bool ok, const char *what, const T &got, const T &expected)
+{
+    if (!ok)
+    {
+        ++failures;
+        if (failures <= 10)
+            printf("FAILED %s: got %s, expected %s\n", what, got.GetDesc().c_str(), expected.GetDesc().c_str());
+    }
+}
+
+#define CHECK_EQ(got, expected) Check((got) == (expected), #got, (got), (expected))
+
+// 不需要 128 位的参考结果：操作数足够小时乘积和被除数都放得进 int64
+static int64_t RoundShift(int64_t v, int fracBits = kFracBit)
+{
+    int64_t m = llabs(v);
+    int64_t r = (m + (1LL << (fracBits - 1))) >> fracBits;
+    return v < 0 ? -r : r;
+}
+
+static int64_t RoundDiv(int64_t n, int64_t d)
+{
+    int64_t q = llabs(n) / llabs(d);
+    int64_t r = llabs(n) % llabs(d);
+    if (r >= llabs(d) - r)
+        ++q;
+    return ((n < 0) != (d < 0)) ? -q : q;
+}
+
+// 批量运算和标量运算逐位相同：每个可用的指令集都和 Fix64 的运算符比较
+static int64_t BatchValue(std::mt19937_64 &rng)
+{
+    static const int64_t kEdges[] = {0, 1, -1, Fix64::kOne, -Fix64::kOne, Fix64::kHalf, -Fix64::kHalf,
+                                     Fix64::kMax, Fix64::kMin, Fix64::kMax - 1, Fix64::kMin + 1,
+                                     1LL << 43, -(1LL << 43), (1LL << 43) + 1, 3037000499LL, -3037000499LL};
+    switch (rng() % 4)
+    {
+    case 0:
+        return kEdges[rng() % (sizeof(kEdges) / sizeof(kEdges[0]))];
+    case 1:
+        return int64_t(rng());
+    default:
+        // 各种大小的值，乘积有的溢出有的不溢出
+        return int64_t(rng() >> (rng() % 64)) * ((rng() & 1) ? 1 : -1);
+    }
+}
+
+static void CheckBatch(const char *isa)
+{
+    std::mt19937_64 rng(5678);
+    // 覆盖整向量之后不同长度的尾部
+    for (size_t n : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1000, 65536})
+    {
+        std::vector<Fix64> a(n), b(n), c(n), out(n);
+        std::vector<uint8_t> mask(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = Fix64::FromRaw(BatchValue(rng));
+            b[i] = Fix64::FromRaw(BatchValue(rng));
+            c[i] = Fix64::FromRaw(BatchValue(rng));
+        }
+
+#define CHECK_BATCH(call, expected)                                                 \
+    do                                                                              \
+    {                                                                               \
+        call;                                                                       \
+        for (size_t i = 0; i < n; ++i)                                              \
+            if (out[i] != (expected))                                               \
+            {                                                                       \
+                printf("%s, n = %zu, i = %zu: ", isa, n, i);                        \
+                Check(false, #call, out[i], (expected));                            \
+                break;                                                              \
+            }                                                                       \
+    } while (0)
+
+        CHECK_BATCH(fix64_batch::Add(a.data(), b.data(), out.data(), n), a[i] + b[i]);
+        CHECK_BATCH(fix64_batch::Sub(a.data(), b.data(), out.data(), n), a[i] - b[i]);
+        CHECK_BATCH(fix64_batch::Mul(a.data(), b.data(), out.data(), n), a[i] * b[i]);
+        CHECK_BATCH(fix64_batch::Div(a.data(), b.data(), out.data(), n), a[i] / b[i]);
+        CHECK_BATCH(fix64_batch::MulAdd(a.data(), b.data(), c.data(), out.data(), n), a[i] * b[i] + c[i]);
+        Fix64 scale = n ? b[n / 2] : Fix64(3);
+        CHECK_BATCH(fix64_batch::ScaleAdd(a.data(), scale, c.data(), out.data(), n), a[i] * scale + c[i]);
+        CHECK_BATCH(fix64_batch::SafeAdd(a.data(), b.data(), out.data(), n), a[i].SafeAdd(b[i]));
+        CHECK_BATCH(fix64_batch::SafeSub(a.data(), b.data(), out.data(), n), a[i].SafeMinus(b[i]));
+        CHECK_BATCH(fix64_batch::SafeMul(a.data(), b.data(), out.data(), n), a[i].SafeMul(b[i]));
+        CHECK_BATCH(fix64_batch::SafeDiv(a.data(), b.data(), out.data(), n), a[i].SafeDiv(b[i]));
+        CHECK_BATCH(fix64_batch::SafeMulAdd(a.data(), b.data(), c.data(), out.data(), n),
+                    a[i].SafeMul(b[i]).SafeAdd(c[i]));
+
+        // 比较和选择：b 的一部分换成 a，让相等的情况也出现
+        for (size_t i = 0; i < n; i += 3)
+            b[i] = a[i];
+        fix64_batch::Less(a.data(), b.data(), mask.data(), n);
+        CHECK_BATCH(fix64_batch::Select(mask.data(), a.data(), b.data(), out.data(), n), a[i] < b[i] ? a[i] : b[i]);
+        fix64_batch::Equal(a.data(), b.data(), mask.data(), n);
+        CHECK_BATCH(fix64_batch::Select(mask.data(), c.data(), a.data(), out.data(), n), a[i] == b[i] ? c[i] : a[i]);
+
+        // 输出和输入是同一个数组
+        out = a;
+        std::vector<Fix64> expected(n);
+        for (size_t i = 0; i < n; ++i)
+            expected[i] = a[i].SafeMul(b[i]);
+        CHECK_BATCH(fix64_batch::SafeMul(out.data(), b.data(), out.data(), n), expected[i]);
+#undef CHECK_BATCH
+    }
+}
+
+// 和 double 的结果相差不超过 1 个 raw 单位
+static void CheckNear(const char *what, const Fix64 &got, double expected)
+{
+    double diff = std::fabs(double(got.GetRaw()) - expected * Fix64::kOne);
+    if (diff > 1)
+        Check(false, what, got, Fix64::FromDouble(expected));
+}
+
+static bool LessEqual(fix64_detail::U128 a, fix64_detail::U128 b)
+{
+    return a.hi < b.hi || (a.hi == b.hi && a.lo <= b.lo);
+}
+
+static void CheckMath()
+{
+    using namespace fix64_math;
+    Fix64 one(1), half = Fix64::FromRaw(Fix64::kHalf);
+    CHECK_EQ(Sqrt(Fix64(4)), Fix64(2));
+    CHECK_EQ(Sqrt(Fix64(2)), Fix64::FromRaw(23726566));
+    CHECK_EQ(Sqrt(Fix64(-1)), Fix64(0));
+    CHECK_EQ(Sin(Fix64(0)), Fix64(0));
+    CHECK_EQ(Cos(Fix64(0)), one);
+    CHECK_EQ(Sin(Fix64::FromRaw(kHalfPi)), one);
+    CHECK_EQ(Atan2(one, one), Fix64::FromRaw(13176795));
+    CHECK_EQ(Atan2(Fix64(0), Fix64(-1)), Fix64::FromRaw(kPi));
+    CHECK_EQ(Atan2(Fix64(-1), Fix64(0)), Fix64::FromRaw(-kHalfPi));
+    CHECK_EQ(Atan2(Fix64(0), Fix64(0)), Fix64(0));
+    CHECK_EQ(Exp(Fix64(0)), one);
+    CHECK_EQ(Exp(one), Fix64::FromRaw(kE));
+    CHECK_EQ(Exp(Fix64(30)), Fix64::FromRaw(Fix64::kMax));
+    CHECK_EQ(Exp(Fix64(-30)), Fix64(0));
+    CHECK_EQ(Log(one), Fix64(0));
+    CHECK_EQ(Log(Fix64(2)), Fix64::FromRaw(kLn2));
+    CHECK_EQ(Log(Fix64(0)), Fix64::FromRaw(Fix64::kMin));
+    CHECK_EQ(Pow(Fix64(2), Fix64(10)), Fix64(1024));
+    CHECK_EQ(Pow(Fix64(-2), Fix64(3)), Fix64(-8));
+    CHECK_EQ(Pow(Fix64(4), half), Fix64(2));
+    CHECK_EQ(Pow(Fix64(-4), half), Fix64(0));
+    CHECK_EQ(Pow(Fix64(0), Fix64(-1)), Fix64::FromRaw(Fix64::kMax));
+    CHECK_EQ(Pow(Fix64(7), Fix64(0)), one);
+
+    std::mt19937_64 rng(91);
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const Fix64 &f) { hash = (hash ^ uint64_t(f.GetRaw())) * 1099511628211ULL; };
+    for (int i = 0; i < 100000; ++i)
+    {
+        // 各种大小的正数
+        int64_t v = int64_t(rng() >> (1 + rng() % 63));
+        if (v == 0)
+            continue;
+        Fix64 x = Fix64::FromRaw(v);
+
+        // Sqrt 正确舍入：(2r - 1)^2 <= 4N <= (2r + 1)^2，N = v * 2^kFracBit
+        uint64_t r = uint64_t(Sqrt(x).GetRaw());
+        fix64_detail::U128 n4 = {uint64_t(v) >> (62 - kFracBit), uint64_t(v) << (kFracBit + 2)};
+        if (!LessEqual(fix64_detail::MulU64(2 * r - 1, 2 * r - 1), n4) || !LessEqual(n4, fix64_detail::MulU64(2 * r + 1, 2 * r + 1)))
+            Check(false, "Sqrt(x) rounding", Sqrt(x), x);
+
+        double real = double(v) / Fix64::kOne;
+        CheckNear("Log(x)", Log(x), std::log(real));
+
+        // 角度不太大时 double 的结果足够准确
+        Fix64 angle = Fix64::FromRaw(int64_t(rng() % (2000ULL << kFracBit)) - (1000LL << kFracBit));
+        double a = double(angle.GetRaw()) / Fix64::kOne;
+        CheckNear("Sin(x)", Sin(angle), std::sin(a));
+        CheckNear("Cos(x)", Cos(angle), std::cos(a));
+        CHECK_EQ(Sin(-angle), -Sin(angle));
+        CHECK_EQ(Cos(-angle), Cos(angle));
+        Fix64 y = Fix64::FromRaw(int64_t(rng() >> (1 + rng() % 63)) * ((rng() & 1) ? 1 : -1));
+        CheckNear("Atan2(y, x)", Atan2(y, angle), std::atan2(double(y.GetRaw()), double(angle.GetRaw())));
+
+        Fix64 e = Fix64::FromRaw(int64_t(rng() % (17ULL << kFracBit)) - (17LL << kFracBit));
+        CheckNear("Exp(x)", Exp(e), std::exp(double(e.GetRaw()) / Fix64::kOne));
+
+        mix(Sqrt(x));
+        mix(Log(x));
+        mix(Sin(angle));
+        mix(Cos(angle));
+        mix(Atan2(y, angle));
+        mix(Exp(e));
+        mix(Pow(x, Fix64::FromRaw(int64_t(rng() % (8ULL << kFracBit)) - (4LL << kFracBit))));
+    }
+    // 所有平台、编译器和两个乘除法后端都必须得到同样的结果
+    const uint64_t kExpectedHash = 0x6d4f2438ff76d4faULL;
+    if (hash != kExpectedHash)
+    {
+        ++failures;
+        printf("FAILED Fix64Math results changed: hash %016llx, expected %016llx\n", (unsigned long long)hash,
+               (unsigned long long)kExpectedHash);
+    }
+}
+
+// 运算符是 constexpr，可以在编译期求值
+static_assert(Fix64(3) * Fix64(-4) == Fix64(-12), "constexpr Fix64 mul");
+static_assert((Fix64(1) / Fix64(3)).GetRaw() == 5592405, "constexpr Fix64 div");
+static_assert(Fix64::FromRaw(Fix64::kMax).SafeAdd(Fix64(1)).GetRaw() == Fix64::kMax, "constexpr Fix64 saturate");
+static_assert(Q16_16(-12) / Q16_16(4) == Q16_16(-3), "constexpr Q16.16 div");
+static_assert((Q16_16(1) / Q16_16(3)).GetRaw() == 21845, "constexpr Q16.16 rounding");
+static_assert(Q32_32::kOne == 1LL << 32 && int64_t(Q32_32::FromDouble(2.5) * Q32_32(3)) == 8, "constexpr Q32.32");
+
+// 32 位的结果按 operator 回绕，按 Safe 饱和
+static int32_t Wrap32(int64_t v)
+{
+    return int32_t(uint32_t(v));
+}
+
+static int32_t Saturate32(int64_t v)
+{
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : int32_t(v));
+}
+
+// Q16.16 和 Q32.32 的规则和 Fix64 相同
+static void CheckFormats()
+{
+    Q16_16 max = Q16_16::FromRaw(Q16_16::kMax), min = Q16_16::FromRaw(Q16_16::kMin);
+    CHECK_EQ(Q16_16(3) * Q16_16(-4), Q16_16(-12));
+    CHECK_EQ(Q16_16::FromRaw(1) * Q16_16::FromRaw(Q16_16::kHalf), Q16_16::FromRaw(1));
+    CHECK_EQ(Q16_16::FromRaw(-1) * Q16_16::FromRaw(Q16_16::kHalf), Q16_16::FromRaw(-1));
+    CHECK_EQ(Q16_16::FromRaw(1) / Q16_16(2), Q16_16::FromRaw(1));
+    CHECK_EQ(Q16_16::FromRaw(-3) / Q16_16(2), Q16_16::FromRaw(-2));
+    CHECK_EQ(Q16_16(5) / Q16_16(0), max);
+    CHECK_EQ(Q16_16(-5) / Q16_16(0), min);
+    CHECK_EQ(Q16_16(0) / Q16_16(0), Q16_16(0));
+    CHECK_EQ(max * Q16_16(2), Q16_16::FromRaw(-2));
+    CHECK_EQ(max.SafeMul(Q16_16(-2)), min);
+    CHECK_EQ(min.SafeMul(Q16_16(-1)), max);
+    CHECK_EQ(-min, min);
+    CHECK_EQ(min.Abs(), max);
+    CHECK_EQ(max.SafeAdd(Q16_16::FromRaw(1)), max);
+    CHECK_EQ(min.SafeMinus(Q16_16::FromRaw(1)), min);
+    CHECK_EQ(max + Q16_16::FromRaw(1), min);
+    CHECK_EQ(Q16_16(int64_t(Q16_16::FromDouble(-2.75))), Q16_16(-3));
+
+    CHECK_EQ(Q32_32(3) * Q32_32(-4), Q32_32(-12));
+    CHECK_EQ(Q32_32(1) / Q32_32(3), Q32_32::FromRaw(1431655765));
+    CHECK_EQ(Q32_32::FromRaw(Q32_32::kMax).SafeMul(Q32_32(2)), Q32_32::FromRaw(Q32_32::kMax));
+
+    std::mt19937_64 rng(4321);
+    for (int i = 0; i < 200000; ++i)
+    {
+        // Q16.16 的乘积和被除数都放得进 int64，可以在整个范围里比较
+        int32_t a = int32_t(uint32_t(rng())), b = int32_t(uint32_t(rng() >> (rng() % 32)));
+        Q16_16 qa = Q16_16::FromRaw(a), qb = Q16_16::FromRaw(b);
+        int64_t product = RoundShift(int64_t(a) * b, 16);
+        CHECK_EQ(qa * qb, Q16_16::FromRaw(Wrap32(product)));
+        CHECK_EQ(qa.SafeMul(qb), Q16_16::FromRaw(Saturate32(product)));
+        if (b != 0)
+        {
+            int64_t quotient = RoundDiv(int64_t(a) * 65536, b);
+            CHECK_EQ(qa / qb, Q16_16::FromRaw(Wrap32(quotient)));
+            CHECK_EQ(qa.SafeDiv(qb), Q16_16::FromRaw(Saturate32(quotient)));
+        }
+
+        // Q32.32：|c|, |d| < 2^31
+        int64_t c = int64_t(rng() >> 32) - (1LL << 31);
+        int64_t d = int64_t(rng() >> 32) - (1LL << 31);
+        Q32_32 qc = Q32_32::FromRaw(c), qd = Q32_32::FromRaw(d);
+        CHECK_EQ(qc * qd, Q32_32::FromRaw(RoundShift(c * d, 32)));
+        if (d != 0)
+            CHECK_EQ(qc / qd, Q32_32::FromRaw(RoundDiv(c * Q32_32::kOne, d)));
+    }
+}
+
+// 向量和矩阵的运算也是 constexpr
+static_assert(fix64_math::Cross(fix64_math::Vec3{Fix64(1), Fix64(0), Fix64(0)},
+                                fix64_math::Vec3{Fix64(0), Fix64(1), Fix64(0)}) ==
+                  fix64_math::Vec3{Fix64(0), Fix64(0), Fix64(1)},
+              "constexpr Cross");
+static_assert(fix64_math::TransformPoint(fix64_math::Translation({Fix64(1), Fix64(2), Fix64(3)}),
+                                         {Fix64(4), Fix64(5), Fix64(6)}) == fix64_math::Vec3{Fix64(5), Fix64(7), Fix64(9)},
+              "constexpr TransformPoint");
+
+static bool Near(const fix64_math::Vec3 &a, const fix64_math::Vec3 &b, int64_t raw)
+{
+    return (a.x - b.x).Abs().GetRaw() <= raw && (a.y - b.y).Abs().GetRaw() <= raw && (a.z - b.z).Abs().GetRaw() <= raw;
+}
+
+// [-range, range) 里的随机数，只用 rng 的原始输出，各个标准库结果相同
+static Fix64 RandomFix64(std::mt19937_64 &rng, int64_t range)
+{
+    return Fix64::FromRaw(int64_t(rng() % (uint64_t(2 * range) << kFracBit)) - (range << kFracBit));
+}
+
+static void CheckVector()
+{
+    using namespace fix64_math;
+    Vec3 x = {Fix64(1), Fix64(0), Fix64(0)}, y = {Fix64(0), Fix64(1), Fix64(0)}, z = {Fix64(0), Fix64(0), Fix64(1)};
+    CHECK_EQ(Dot(Vec3{Fix64(1), Fix64(2), Fix64(3)}, Vec3{Fix64(4), Fix64(-5), Fix64(6)}), Fix64(12));
+    CHECK_EQ(Cross(Vec2{Fix64(1), Fix64(0)}, Vec2{Fix64(0), Fix64(1)}), Fix64(1));
+    CHECK_EQ(Length(Vec3{Fix64(2), Fix64(3), Fix64(6)}), Fix64(7));
+    Vec3 n = Normalize(Vec3{Fix64(3), Fix64(0), Fix64(-4)});
+    CHECK_EQ(n.x, Fix64(3) / Fix64(5));
+    CHECK_EQ(n.z, Fix64(-4) / Fix64(5));
+    CHECK_EQ(Normalize(Vec4{}).w, Fix64(0));
+
+    // 绕 z 轴 90 度：x 转到 y，四元数和矩阵的结果一致
+    Quaternion q = FromAxisAngle(z, Fix64::FromRaw(kHalfPi));
+    Check(Near(Rotate(q, x), y, 2), "Rotate(q, x)", Rotate(q, x).x, y.x);
+    Check(Near(TransformVector(Rotation(q), x), y, 2), "Rotation(q) x", TransformVector(Rotation(q), x).x, y.x);
+    Check(Near(Rotate(Conjugate(q), y), x, 2), "Rotate(Conjugate(q), y)", Rotate(Conjugate(q), y).y, x.y);
+    Quaternion half = FromAxisAngle(z, Fix64::FromRaw(kHalfPi / 2));
+    Check(Near(Rotate(half * half, x), y, 4), "Rotate(half * half, x)", Rotate(half * half, x).x, y.x);
+    CHECK_EQ(Length(Quaternion::Identity()), Fix64(1));
+
+    Mat4 m = Translation({Fix64(1), Fix64(2), Fix64(3)}) * Scaling({Fix64(2), Fix64(3), Fix64(4)});
+    CHECK_EQ(TransformPoint(m, {Fix64(1), Fix64(1), Fix64(1)}).z, Fix64(7));
+    CHECK_EQ(TransformVector(m, {Fix64(1), Fix64(1), Fix64(1)}).z, Fix64(4));
+    CHECK_EQ(Transform(Transpose(m), Vec4{Fix64(0), Fix64(0), Fix64(0), Fix64(1)}).w, Fix64(1));
+    Check(Mat4::Identity() * m == m && Transpose(Transpose(m)) == m, "Mat4 identity", Fix64(0), Fix64(0));
+
+    // 刚体积分：结构数组的批量版本在每个指令集上都和逐个积分逐位相同
+    std::mt19937_64 rng(2468);
+    const size_t kBodies = 37;
+    std::vector<RigidBody> bodies(kBodies);
+    for (RigidBody &b : bodies)
+    {
+        b.position = {RandomFix64(rng, 1000), RandomFix64(rng, 1000), RandomFix64(rng, 1000)};
+        b.velocity = {RandomFix64(rng, 10), RandomFix64(rng, 10), RandomFix64(rng, 10)};
+        b.acceleration = {RandomFix64(rng, 1), RandomFix64(rng, 1) - Fix64(10), RandomFix64(rng, 1)};
+        Vec3 axis = Normalize(Vec3{RandomFix64(rng, 1), RandomFix64(rng, 1), RandomFix64(rng, 1)});
+        b.orientation = FromAxisAngle(axis, RandomFix64(rng, 3));
+        b.angularVelocity = {RandomFix64(rng, 2), RandomFix64(rng, 2), RandomFix64(rng, 2)};
+    }
+    RigidBodies batch;
+    batch.Resize(kBodies);
+    for (size_t i = 0; i < kBodies; ++i)
+        batch.Set(i, bodies[i]);
+
+    Fix64 dt = Fix64(1) / Fix64(60);
+    for (int step = 0; step < 300; ++step)
+        for (RigidBody &b : bodies)
+            Integrate(&b, dt);
+    uint64_t checksum = Checksum(bodies.data(), bodies.size());
+    // 牛顿迭代让姿态保持单位长度
+    for (const RigidBody &b : bodies)
+        Check((Length(b.orientation) - Fix64(1)).Abs().GetRaw() <= 16, "Length(orientation)", Length(b.orientation), Fix64(1));
+
+    fix64_batch::Isa active = fix64_batch::ActiveIsa();
+    for (fix64_batch::Isa isa : {fix64_batch::Isa::kScalar, fix64_batch::Isa::kAvx2, fix64_batch::Isa::kAvx512})
+    {
+        if (!fix64_batch::SetIsa(isa))
+            continue;
+        RigidBodies copy = batch;
+        for (int step = 0; step < 300; ++step)
+            Integrate(&copy, dt);
+        if (Checksum(copy) != checksum)
+        {
+            ++failures;
+            printf("FAILED Integrate(RigidBodies *) on %s differs from Integrate(RigidBody *)\n", fix64_batch::IsaName(isa));
+        }
+    }
+    fix64_batch::SetIsa(active);
+
+    const uint64_t kExpectedChecksum = 0xda4aabab928fff61ULL;
+    if (checksum != kExpectedChecksum)
+    {
+        ++failures;
+        printf("FAILED rigid body results changed: checksum %016llx, expected %016llx\n", (unsigned long long)checksum,
+               (unsigned long long)kExpectedChecksum);
+    }
+}
 
 int main()
 {
     Fix64 aa = Fix64::FromRaw(Fix64::kMax);
     Fix64 bb = Fix64(1);
-    auto var = aa * bb;
+    CHECK_EQ(aa * bb, aa);
+    CHECK_EQ(Fix64(3) * Fix64(-4), Fix64(-12));
+    CHECK_EQ(Fix64(-12) / Fix64(4), Fix64(-3));
+
+    // 舍入到最近，一半时远离 0
+    Fix64 half = Fix64::FromRaw(Fix64::kHalf);
+    CHECK_EQ(Fix64::FromRaw(1) * half, Fix64::FromRaw(1));
+    CHECK_EQ(Fix64::FromRaw(-1) * half, Fix64::FromRaw(-1));
+    CHECK_EQ(Fix64::FromRaw(1) * Fix64::FromRaw(Fix64::kHalf - 1), Fix64::FromRaw(0));
+    CHECK_EQ(Fix64(1) / Fix64(3), Fix64::FromRaw(5592405));
+    CHECK_EQ(Fix64(2) / Fix64(3), Fix64::FromRaw(11184811));
+    CHECK_EQ(Fix64(-2) / Fix64(3), Fix64::FromRaw(-11184811));
+
+    // 除零
+    CHECK_EQ(Fix64(5) / Fix64(0), Fix64::FromRaw(Fix64::kMax));
+    CHECK_EQ(Fix64(-5) / Fix64(0), Fix64::FromRaw(Fix64::kMin));
+    CHECK_EQ(Fix64(0) / Fix64(0), Fix64(0));
+
+    // 溢出：operator 回绕，Safe 饱和
+    CHECK_EQ(aa * Fix64(2), Fix64::FromRaw(-2));
+    CHECK_EQ(aa.SafeMul(Fix64(2)), aa);
+    CHECK_EQ(aa.SafeMul(Fix64(-2)), Fix64::FromRaw(Fix64::kMin));
+    CHECK_EQ(Fix64::FromRaw(Fix64::kMin).SafeMul(Fix64(-1)), aa);
+    CHECK_EQ(aa.SafeDiv(half), aa);
+    CHECK_EQ(aa.SafeDiv(-half), Fix64::FromRaw(Fix64::kMin));
+    CHECK_EQ(Fix64(7).SafeMul(Fix64(6)), Fix64(42));
+
+    std::mt19937_64 rng(1234);
+    for (int i = 0; i < 1000000; ++i)
+    {
+        // |a|, |b| < 2^31：a * b 放得进 int64
+        int64_t a = int64_t(rng() >> 32) - (1LL << 31);
+        int64_t b = int64_t(rng() >> 32) - (1LL << 31);
+        Fix64 fa = Fix64::FromRaw(a), fb = Fix64::FromRaw(b);
+        CHECK_EQ(fa * fb, Fix64::FromRaw(RoundShift(a * b)));
+        CHECK_EQ((-fa) * fb, -(fa * fb));
+
+        // |c| < 2^39：c << kFracBit 放得进 int64
+        int64_t c = int64_t(rng() >> 25) - (1LL << 38);
+        int64_t d = int64_t(rng() >> (1 + rng() % 63)) * ((rng() & 1) ? 1 : -1);
+        if (d == 0)
+            continue;
+        Fix64 fc = Fix64::FromRaw(c), fd = Fix64::FromRaw(d);
+        CHECK_EQ(fc / fd, Fix64::FromRaw(RoundDiv(c * Fix64::kOne, d)));
+        CHECK_EQ(fc.SafeDiv(fd), fc / fd);
+    }
+
+    CheckFormats();
+    CheckMath();
+    CheckVector();
+
+    fix64_batch::Isa active = fix64_batch::ActiveIsa();
+    for (fix64_batch::Isa isa : {fix64_batch::Isa::kScalar, fix64_batch::Isa::kAvx2, fix64_batch::Isa::kAvx512})
+    {
+        if (!fix64_batch::SetIsa(isa))
+        {
+            printf("batch %s: not supported, skipped\n", fix64_batch::IsaName(isa));
+            continue;
+        }
+        CheckBatch(fix64_batch::IsaName(isa));
+    }
+    fix64_batch::SetIsa(active);
+
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("cpptest ok\n");
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,118 @@
+// Fix64Math 和 long double 的 <cmath> 比较，打印每个函数在各个区间的误差
+//   ulp: |结果 - 精确值| / 2^-24
+//   rel: 超出舍入误差（0.5 ulp）的部分和 |精确值| 的比，只统计 |精确值| >= 1 的结果；
+//        大的结果上是内部计算的相对精度
+// 用法: fix64_accuracy [samples per row]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "Fix64.h"
+#include "Fix64Math.h"
+
+namespace {
+
+std::mt19937_64 rng(42);
+const double kPi = 3.14159265358979323846;
+
+long double ToReal(const Fix64 &f) { return (long double)f.GetRaw() / Fix64::kOne; }
+Fix64 Raw(int64_t v) { return Fix64::FromRaw(v); }
+
+// [lo, hi) 里均匀分布的 raw 值
+Fix64 Uniform(double lo, double hi) {
+  std::uniform_real_distribution<double> dist(lo, hi);
+  return Raw(int64_t(std::llround(dist(rng) * Fix64::kOne)));
+}
+
+// 2^lo 到 2^hi 之间对数均匀分布的正数
+Fix64 LogUniform(double lo, double hi) {
+  std::uniform_real_distribution<double> dist(lo, hi);
+  int64_t raw = int64_t(std::llround(std::exp2(dist(rng)) * Fix64::kOne));
+  return Raw(raw > 0 ? raw : 1);
+}
+
+struct Error {
+  long double maxUlp = 0, sumUlp = 0, maxRel = 0;
+  long samples = 0;
+
+  void Add(const Fix64 &got, long double exact) {
+    // 超出 Fix64 范围的结果饱和，不统计
+    if (std::fabs(exact) >= (long double)Fix64::kMax / Fix64::kOne)
+      return;
+    long double ulp = std::fabs(ToReal(got) - exact) * Fix64::kOne;
+    maxUlp = std::max(maxUlp, ulp);
+    sumUlp += ulp;
+    if (ulp > 0.5L && std::fabs(exact) >= 1)
+      maxRel = std::max(maxRel, (ulp - 0.5L) / Fix64::kOne / std::fabs(exact));
+    ++samples;
+  }
+
+  void Print(const char *function, const char *range) const {
+    printf("%-6s %-26s %9ld %9.3Lf %9.3Lf", function, range, samples, maxUlp, samples ? sumUlp / samples : 0);
+    if (maxRel > 0)
+      printf("   2^%.1f", double(std::log2(maxRel)));
+    printf("\n");
+  }
+};
+
+template <typename Gen, typename Check>
+void Report(const char *function, const char *range, long n, Gen gen, Check check) {
+  Error error;
+  for (long i = 0; i < n; ++i)
+    check(error, gen());
+  error.Print(function, range);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long n = argc > 1 ? atol(argv[1]) : 1000000;
+  printf("%-6s %-26s %9s %9s %9s   %s\n", "func", "range", "samples", "max ulp", "mean ulp", "max rel");
+
+  auto sqrt = [](Error &e, Fix64 x) { e.Add(fix64_math::Sqrt(x), std::sqrt(ToReal(x))); };
+  Report("Sqrt", "[2^-24, 1]", n, [] { return LogUniform(-24, 0); }, sqrt);
+  Report("Sqrt", "[1, 2^39]", n, [] { return LogUniform(0, 39); }, sqrt);
+
+  auto sin = [](Error &e, Fix64 x) { e.Add(fix64_math::Sin(x), std::sin(ToReal(x))); };
+  auto cos = [](Error &e, Fix64 x) { e.Add(fix64_math::Cos(x), std::cos(ToReal(x))); };
+  Report("Sin", "[-pi, pi]", n, [] { return Uniform(-kPi, kPi); }, sin);
+  Report("Sin", "[-10^6, 10^6]", n, [] { return Uniform(-1e6, 1e6); }, sin);
+  Report("Cos", "[-pi, pi]", n, [] { return Uniform(-kPi, kPi); }, cos);
+  Report("Cos", "[-10^6, 10^6]", n, [] { return Uniform(-1e6, 1e6); }, cos);
+
+  auto atan2 = [](Error &e, Fix64 y) {
+    Fix64 x = Uniform(-1, 1);
+    e.Add(fix64_math::Atan2(y, x), std::atan2(ToReal(y), ToReal(x)));
+  };
+  Report("Atan2", "y, x in [-1, 1]", n, [] { return Uniform(-1, 1); }, atan2);
+  auto atan2Wide = [](Error &e, Fix64 y) {
+    Fix64 x = LogUniform(-24, 39);
+    if (rng() & 1)
+      x = -x;
+    e.Add(fix64_math::Atan2(y, x), std::atan2(ToReal(y), ToReal(x)));
+  };
+  Report("Atan2", "|y|, |x| in [2^-24, 2^39]", n, [] { return (rng() & 1) ? LogUniform(-24, 39) : -LogUniform(-24, 39); },
+         atan2Wide);
+
+  auto exp = [](Error &e, Fix64 x) { e.Add(fix64_math::Exp(x), std::exp(ToReal(x))); };
+  Report("Exp", "[-17, 0]", n, [] { return Uniform(-17, 0); }, exp);
+  Report("Exp", "[0, 27]", n, [] { return Uniform(0, 27); }, exp);
+
+  auto log = [](Error &e, Fix64 x) { e.Add(fix64_math::Log(x), std::log(ToReal(x))); };
+  Report("Log", "[2^-24, 1]", n, [] { return LogUniform(-24, 0); }, log);
+  Report("Log", "[1, 2^39]", n, [] { return LogUniform(0, 39); }, log);
+
+  auto pow = [](Error &e, Fix64 x) {
+    Fix64 y = Uniform(-8, 8);
+    e.Add(fix64_math::Pow(x, y), std::pow(ToReal(x), ToReal(y)));
+  };
+  Report("Pow", "x in [2^-4, 2^4]", n, [] { return LogUniform(-4, 4); }, pow);
+  auto powInteger = [](Error &e, Fix64 x) {
+    Fix64 y = Fix64(int64_t(rng() % 9) - 4);
+    e.Add(fix64_math::Pow(x, y), std::pow(ToReal(x), ToReal(y)));
+  };
+  Report("Pow", "x in [-100, 100], y int", n, [] { return Uniform(-100, 100); }, powInteger);
+  return 0;
+}
@@ -0,0 +1,538 @@
+// Fix64 乘除法的各个实现
+//   mul: 原来 operator* 的四个部分积（截断，不处理符号进位）、__int128、不依赖 __int128 的实现，
+//        以及 Fix64 的 operator*
+//   div: __int128 和不依赖 __int128 的实现，以及 operator/（原来的 _div128 只有 MSVC 有）
+//   batch *: Fix64Batch 的各个指令集，和逐个调用 Fix64 运算符的循环比较
+//   math *: Fix64Math，和转换成 double 调用 <cmath> 再 FromDouble 比较
+//   inline *: 运算符组成的循环，内联的运算符和 fix64_bench_outline.cc 里不内联的版本
+//        （相当于原来在 Fix64.cc 里实现的时候）执行同样的循环
+//   formats: Q40.24 (Fix64)、Q32.32 和 Q16.16 的同一段计算
+//   integrate: 刚体积分，逐个积分 RigidBody 和结构数组的 RigidBodies（各指令集）；
+//        每个版本打印结果的 checksum，和下面记录的值比较，不同编译器和平台应该完全相同
+// 使用 ../benchmark 的 picobench runner，例如 --samples=5 --json=out.json
+
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Fix64.h"
+#include "Fix64Batch.h"
+#include "Fix64Math.h"
+#include "Fix64Vector.h"
+#include "Fix64Wide.h"
+
+// 原来的 operator*：整数和小数部分分开相乘
+static int64_t MulPartialProduct(int64_t x, int64_t y) {
+  uint64_t mask = ~(~0ULL << kFracBit);
+  uint64_t xfrac = x & mask;
+  uint64_t xinteger = x >> kFracBit;
+  uint64_t yfrac = y & mask;
+  uint64_t yinteger = y >> kFracBit;
+  auto xyff = xfrac * yfrac >> kFracBit;
+  auto xyfi = xfrac * yinteger;
+  auto yxfi = yfrac * xinteger;
+  auto xyii = xinteger * yinteger << kFracBit;
+  return int64_t(xyii + xyfi + yxfi + xyff);
+}
+
+// 绝对值在 2^20 以内的数，乘积和商都不会溢出
+static const std::vector<int64_t> &Operands(size_t n, uint64_t seed) {
+  static std::vector<int64_t> values;
+  values.resize(n);
+  std::mt19937_64 rng(seed);
+  for (auto &v : values) {
+    v = int64_t(rng() % (2 * Fix64::kOne << 20)) - (Fix64::kOne << 20);
+    if (v == 0)
+      v = 1;
+  }
+  return values;
+}
+
+template <typename Op>
+void Run(picobench::state &s, Op op) {
+  std::vector<int64_t> a = Operands(s.iterations(), 1);
+  std::vector<int64_t> b = Operands(s.iterations(), 2);
+  int64_t sum = 0;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum += op(a[i], b[i]);
+  }
+  s.set_result(uintptr_t(sum));
+}
+
+static void mul_partial_product(picobench::state &s) { Run(s, MulPartialProduct); }
+static void mul_portable(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return fix64_detail::MulPortable<kFracBit>(x, y, false); });
+}
+#ifdef FIX64_HAS_INT128
+static void mul_int128(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return fix64_detail::MulInt128<kFracBit>(x, y, false); });
+}
+#endif
+static void mul_operator(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return (Fix64::FromRaw(x) * Fix64::FromRaw(y)).GetRaw(); });
+}
+static void mul_saturating(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return Fix64::FromRaw(x).SafeMul(Fix64::FromRaw(y)).GetRaw(); });
+}
+
+PICOBENCH_SUITE("mul");
+PICOBENCH(mul_partial_product).iterations({1024, 65536}).baseline();
+PICOBENCH(mul_portable).iterations({1024, 65536});
+#ifdef FIX64_HAS_INT128
+PICOBENCH(mul_int128).iterations({1024, 65536});
+#endif
+PICOBENCH(mul_operator).iterations({1024, 65536});
+PICOBENCH(mul_saturating).iterations({1024, 65536});
+
+static void div_portable(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return fix64_detail::DivPortable<kFracBit>(x, y, false); });
+}
+#ifdef FIX64_HAS_INT128
+static void div_int128(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return fix64_detail::DivInt128<kFracBit>(x, y, false); });
+}
+#endif
+static void div_operator(picobench::state &s) {
+  Run(s, [](int64_t x, int64_t y) { return (Fix64::FromRaw(x) / Fix64::FromRaw(y)).GetRaw(); });
+}
+
+PICOBENCH_SUITE("div");
+PICOBENCH(div_portable).iterations({1024, 65536}).baseline();
+#ifdef FIX64_HAS_INT128
+PICOBENCH(div_int128).iterations({1024, 65536});
+#endif
+PICOBENCH(div_operator).iterations({1024, 65536});
+
+// 批量接口：每个运算有逐个调用运算符的循环（baseline）和各指令集的 kernel
+struct BatchMul {
+  static Fix64 Loop(const Fix64 &a, const Fix64 &b, const Fix64 &) { return a * b; }
+  static void Batch(const int64_t *a, const int64_t *b, const int64_t *, int64_t *out, size_t n) {
+    fix64_batch::Mul(a, b, out, n);
+  }
+};
+struct BatchMulAdd {
+  static Fix64 Loop(const Fix64 &a, const Fix64 &b, const Fix64 &c) { return a * b + c; }
+  static void Batch(const int64_t *a, const int64_t *b, const int64_t *c, int64_t *out, size_t n) {
+    fix64_batch::MulAdd(a, b, c, out, n);
+  }
+};
+struct BatchSafeMul {
+  static Fix64 Loop(const Fix64 &a, const Fix64 &b, const Fix64 &) { return a.SafeMul(b); }
+  static void Batch(const int64_t *a, const int64_t *b, const int64_t *, int64_t *out, size_t n) {
+    fix64_batch::SafeMul(a, b, out, n);
+  }
+};
+struct BatchSafeAdd {
+  static Fix64 Loop(const Fix64 &a, const Fix64 &b, const Fix64 &) { return a.SafeAdd(b); }
+  static void Batch(const int64_t *a, const int64_t *b, const int64_t *, int64_t *out, size_t n) {
+    fix64_batch::SafeAdd(a, b, out, n);
+  }
+};
+
+template <typename Op>
+void batch_loop(picobench::state &s) {
+  std::vector<Fix64> a(s.iterations()), b(s.iterations()), c(s.iterations()), out(s.iterations());
+  for (int k = 0; k < 3; ++k) {
+    std::vector<Fix64> &v = k == 0 ? a : k == 1 ? b : c;
+    const std::vector<int64_t> &raw = Operands(v.size(), k + 1);
+    for (size_t i = 0; i < v.size(); ++i)
+      v[i] = Fix64::FromRaw(raw[i]);
+  }
+  {
+    bench::perf_scope scope(s);
+    for (size_t i = 0; i < out.size(); ++i)
+      out[i] = Op::Loop(a[i], b[i], c[i]);
+  }
+  s.set_result(uintptr_t(out.back().GetRaw()));
+}
+
+template <typename Op, fix64_batch::Isa isa>
+void batch_kernel(picobench::state &s) {
+  std::vector<int64_t> a = Operands(s.iterations(), 1);
+  std::vector<int64_t> b = Operands(s.iterations(), 2);
+  std::vector<int64_t> c = Operands(s.iterations(), 3);
+  std::vector<int64_t> out(s.iterations());
+  fix64_batch::Isa active = fix64_batch::ActiveIsa();
+  if (!fix64_batch::SetIsa(isa)) {
+    static bool reported = false;
+    if (!reported)
+      fprintf(stderr, "%s is not supported, measuring %s\n", fix64_batch::IsaName(isa), fix64_batch::IsaName(active));
+    reported = true;
+  }
+  {
+    bench::perf_scope scope(s);
+    Op::Batch(a.data(), b.data(), c.data(), out.data(), out.size());
+  }
+  fix64_batch::SetIsa(active);
+  s.set_result(uintptr_t(out.back()));
+}
+
+using fix64_batch::Isa;
+
+PICOBENCH_SUITE("batch mul");
+PICOBENCH(batch_loop<BatchMul>).label("mul_loop").iterations({1024, 65536}).baseline();
+PICOBENCH((batch_kernel<BatchMul, Isa::kScalar>)).label("mul_scalar").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchMul, Isa::kAvx2>)).label("mul_avx2").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchMul, Isa::kAvx512>)).label("mul_avx512").iterations({1024, 65536});
+
+PICOBENCH_SUITE("batch muladd");
+PICOBENCH(batch_loop<BatchMulAdd>).label("muladd_loop").iterations({1024, 65536}).baseline();
+PICOBENCH((batch_kernel<BatchMulAdd, Isa::kScalar>)).label("muladd_scalar").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchMulAdd, Isa::kAvx2>)).label("muladd_avx2").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchMulAdd, Isa::kAvx512>)).label("muladd_avx512").iterations({1024, 65536});
+
+PICOBENCH_SUITE("batch safe mul");
+PICOBENCH(batch_loop<BatchSafeMul>).label("safe_mul_loop").iterations({1024, 65536}).baseline();
+PICOBENCH((batch_kernel<BatchSafeMul, Isa::kScalar>)).label("safe_mul_scalar").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchSafeMul, Isa::kAvx2>)).label("safe_mul_avx2").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchSafeMul, Isa::kAvx512>)).label("safe_mul_avx512").iterations({1024, 65536});
+
+PICOBENCH_SUITE("batch safe add");
+PICOBENCH(batch_loop<BatchSafeAdd>).label("safe_add_loop").iterations({1024, 65536}).baseline();
+PICOBENCH((batch_kernel<BatchSafeAdd, Isa::kScalar>)).label("safe_add_scalar").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchSafeAdd, Isa::kAvx2>)).label("safe_add_avx2").iterations({1024, 65536});
+PICOBENCH((batch_kernel<BatchSafeAdd, Isa::kAvx512>)).label("safe_add_avx512").iterations({1024, 65536});
+
+// [lo, hi) 里均匀分布的参数
+static std::vector<Fix64> MathOperands(size_t n, uint64_t seed, double lo, double hi) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> dist(lo, hi);
+  std::vector<Fix64> values(n);
+  for (auto &v : values)
+    v = Fix64::FromDouble(dist(rng));
+  return values;
+}
+
+template <typename Op>
+void RunMath(picobench::state &s, double lo, double hi, Op op) {
+  std::vector<Fix64> a = MathOperands(s.iterations(), 1, lo, hi);
+  int64_t sum = 0;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum += op(a[i]).GetRaw();
+  }
+  s.set_result(uintptr_t(sum));
+}
+
+template <typename Op>
+void RunMath2(picobench::state &s, double lo, double hi, double lo2, double hi2, Op op) {
+  std::vector<Fix64> a = MathOperands(s.iterations(), 1, lo, hi);
+  std::vector<Fix64> b = MathOperands(s.iterations(), 2, lo2, hi2);
+  int64_t sum = 0;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum += op(a[i], b[i]).GetRaw();
+  }
+  s.set_result(uintptr_t(sum));
+}
+
+static void sqrt_double(picobench::state &s) {
+  RunMath(s, 0, 1e6, [](const Fix64 &x) { return Fix64::FromDouble(std::sqrt(double(x))); });
+}
+static void sqrt_fix64(picobench::state &s) { RunMath(s, 0, 1e6, fix64_math::Sqrt); }
+
+PICOBENCH_SUITE("math sqrt");
+PICOBENCH(sqrt_double).iterations({1024, 65536}).baseline();
+PICOBENCH(sqrt_fix64).iterations({1024, 65536});
+
+static void sin_double(picobench::state &s) {
+  RunMath(s, -1000, 1000, [](const Fix64 &x) { return Fix64::FromDouble(std::sin(double(x))); });
+}
+static void sin_fix64(picobench::state &s) { RunMath(s, -1000, 1000, fix64_math::Sin); }
+
+PICOBENCH_SUITE("math sin");
+PICOBENCH(sin_double).iterations({1024, 65536}).baseline();
+PICOBENCH(sin_fix64).iterations({1024, 65536});
+
+static void atan2_double(picobench::state &s) {
+  RunMath2(s, -1000, 1000, -1000, 1000, [](const Fix64 &y, const Fix64 &x) {
+    return Fix64::FromDouble(std::atan2(double(y), double(x)));
+  });
+}
+static void atan2_fix64(picobench::state &s) { RunMath2(s, -1000, 1000, -1000, 1000, fix64_math::Atan2); }
+
+PICOBENCH_SUITE("math atan2");
+PICOBENCH(atan2_double).iterations({1024, 65536}).baseline();
+PICOBENCH(atan2_fix64).iterations({1024, 65536});
+
+static void exp_double(picobench::state &s) {
+  RunMath(s, -17, 27, [](const Fix64 &x) { return Fix64::FromDouble(std::exp(double(x))); });
+}
+static void exp_fix64(picobench::state &s) { RunMath(s, -17, 27, fix64_math::Exp); }
+
+PICOBENCH_SUITE("math exp");
+PICOBENCH(exp_double).iterations({1024, 65536}).baseline();
+PICOBENCH(exp_fix64).iterations({1024, 65536});
+
+static void log_double(picobench::state &s) {
+  RunMath(s, 0.001, 1e6, [](const Fix64 &x) { return Fix64::FromDouble(std::log(double(x))); });
+}
+static void log_fix64(picobench::state &s) { RunMath(s, 0.001, 1e6, fix64_math::Log); }
+
+PICOBENCH_SUITE("math log");
+PICOBENCH(log_double).iterations({1024, 65536}).baseline();
+PICOBENCH(log_fix64).iterations({1024, 65536});
+
+static void pow_double(picobench::state &s) {
+  RunMath2(s, 0.01, 100, -4, 4, [](const Fix64 &x, const Fix64 &y) {
+    return Fix64::FromDouble(std::pow(double(x), double(y)));
+  });
+}
+static void pow_fix64(picobench::state &s) { RunMath2(s, 0.01, 100, -4, 4, fix64_math::Pow); }
+
+PICOBENCH_SUITE("math pow");
+PICOBENCH(pow_double).iterations({1024, 65536}).baseline();
+PICOBENCH(pow_fix64).iterations({1024, 65536});
+
+
+// 运算符组成的常见循环，只用 Fix64 的公开接口；
+// 运算符可以内联以后，编译器能把整个循环放在寄存器里。
+// 同样的循环分别通过 InlineOps 和 OutOfLineOps 执行，后者调用另一个编译单元里不内联的版本
+namespace fix64_outline {
+// 定义在 fix64_bench_outline.cc
+Fix64 Add(const Fix64 &a, const Fix64 &b);
+Fix64 Mul(const Fix64 &a, const Fix64 &b);
+Fix64 SafeAdd(const Fix64 &a, const Fix64 &b);
+Fix64 Abs(const Fix64 &a);
+bool Less(const Fix64 &a, const Fix64 &b);
+} // namespace fix64_outline
+
+struct InlineOps {
+  static Fix64 Add(const Fix64 &a, const Fix64 &b) { return a + b; }
+  static Fix64 Mul(const Fix64 &a, const Fix64 &b) { return a * b; }
+  static Fix64 SafeAdd(const Fix64 &a, const Fix64 &b) { return a.SafeAdd(b); }
+  static Fix64 Abs(const Fix64 &a) { return a.Abs(); }
+  static bool Less(const Fix64 &a, const Fix64 &b) { return a < b; }
+};
+
+struct OutOfLineOps {
+  static Fix64 Add(const Fix64 &a, const Fix64 &b) { return fix64_outline::Add(a, b); }
+  static Fix64 Mul(const Fix64 &a, const Fix64 &b) { return fix64_outline::Mul(a, b); }
+  static Fix64 SafeAdd(const Fix64 &a, const Fix64 &b) { return fix64_outline::SafeAdd(a, b); }
+  static Fix64 Abs(const Fix64 &a) { return fix64_outline::Abs(a); }
+  static bool Less(const Fix64 &a, const Fix64 &b) { return fix64_outline::Less(a, b); }
+};
+
+static std::vector<Fix64> InlineOperands(size_t n, uint64_t seed) {
+  const std::vector<int64_t> &raw = Operands(n, seed);
+  std::vector<Fix64> values(n);
+  for (size_t i = 0; i < n; ++i)
+    values[i] = Fix64::FromRaw(raw[i] >> 10);
+  return values;
+}
+
+template <typename Ops>
+void inline_dot(picobench::state &s) {
+  std::vector<Fix64> a = InlineOperands(s.iterations(), 1);
+  std::vector<Fix64> b = InlineOperands(s.iterations(), 2);
+  Fix64 sum;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum = Ops::Add(sum, Ops::Mul(a[i], b[i]));
+  }
+  s.set_result(uintptr_t(sum.GetRaw()));
+}
+
+template <typename Ops>
+void inline_axpy(picobench::state &s) {
+  std::vector<Fix64> x = InlineOperands(s.iterations(), 1);
+  std::vector<Fix64> y = InlineOperands(s.iterations(), 2);
+  Fix64 a = Fix64::FromDouble(0.75);
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      y[i] = Ops::Add(Ops::Mul(a, x[i]), y[i]);
+  }
+  s.set_result(uintptr_t(y.back().GetRaw()));
+}
+
+// 三次多项式，Horner 法
+template <typename Ops>
+void inline_poly(picobench::state &s) {
+  std::vector<Fix64> x = InlineOperands(s.iterations(), 1);
+  Fix64 c0 = Fix64(1), c1 = Fix64::FromDouble(-0.5), c2 = Fix64::FromDouble(0.25), c3 = Fix64::FromDouble(0.125);
+  Fix64 sum;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s) {
+      Fix64 p = Ops::Add(Ops::Mul(c3, x[i]), c2);
+      p = Ops::Add(Ops::Mul(p, x[i]), c1);
+      p = Ops::Add(Ops::Mul(p, x[i]), c0);
+      sum = Ops::Add(sum, p);
+    }
+  }
+  s.set_result(uintptr_t(sum.GetRaw()));
+}
+
+// 比较、取绝对值和饱和加法
+template <typename Ops>
+void inline_clamp(picobench::state &s) {
+  std::vector<Fix64> x = InlineOperands(s.iterations(), 1);
+  Fix64 lo = Fix64(-100), hi = Fix64(100);
+  Fix64 sum;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s) {
+      Fix64 v = Ops::Less(x[i], lo) ? lo : Ops::Less(hi, x[i]) ? hi : x[i];
+      sum = Ops::SafeAdd(sum, Ops::Abs(v));
+    }
+  }
+  s.set_result(uintptr_t(sum.GetRaw()));
+}
+
+PICOBENCH_SUITE("inline dot");
+PICOBENCH(inline_dot<OutOfLineOps>).label("dot_out_of_line").iterations({1024, 65536}).baseline();
+PICOBENCH(inline_dot<InlineOps>).label("dot_inline").iterations({1024, 65536});
+
+PICOBENCH_SUITE("inline axpy");
+PICOBENCH(inline_axpy<OutOfLineOps>).label("axpy_out_of_line").iterations({1024, 65536}).baseline();
+PICOBENCH(inline_axpy<InlineOps>).label("axpy_inline").iterations({1024, 65536});
+
+PICOBENCH_SUITE("inline poly");
+PICOBENCH(inline_poly<OutOfLineOps>).label("poly_out_of_line").iterations({1024, 65536}).baseline();
+PICOBENCH(inline_poly<InlineOps>).label("poly_inline").iterations({1024, 65536});
+
+PICOBENCH_SUITE("inline clamp");
+PICOBENCH(inline_clamp<OutOfLineOps>).label("clamp_out_of_line").iterations({1024, 65536}).baseline();
+PICOBENCH(inline_clamp<InlineOps>).label("clamp_inline").iterations({1024, 65536});
+
+// 同样的多项式和点积，三种格式；参数在 [-4, 4)，Q16.16 也不会溢出
+template <typename T>
+void format_poly(picobench::state &s) {
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> dist(-4, 4);
+  std::vector<T> x(s.iterations());
+  for (auto &v : x)
+    v = T::FromDouble(dist(rng));
+  T c0 = T(1), c1 = T::FromDouble(-0.5), c2 = T::FromDouble(0.25), c3 = T::FromDouble(0.125);
+  T sum;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum = sum + ((c3 * x[i] + c2) * x[i] + c1) * x[i] + c0;
+  }
+  s.set_result(uintptr_t(sum.GetRaw()));
+}
+
+template <typename T>
+void format_dot(picobench::state &s) {
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> dist(-4, 4);
+  std::vector<T> a(s.iterations()), b(s.iterations());
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = T::FromDouble(dist(rng));
+    b[i] = T::FromDouble(dist(rng)) / T(64);
+  }
+  T sum;
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s)
+      sum = sum + a[i] * b[i];
+  }
+  s.set_result(uintptr_t(sum.GetRaw()));
+}
+
+PICOBENCH_SUITE("formats");
+PICOBENCH(format_poly<Fix64>).label("poly_q40_24").iterations({1024, 65536}).baseline();
+PICOBENCH(format_poly<Q32_32>).label("poly_q32_32").iterations({1024, 65536});
+PICOBENCH(format_poly<Q16_16>).label("poly_q16_16").iterations({1024, 65536});
+PICOBENCH(format_dot<Fix64>).label("dot_q40_24").iterations({1024, 65536});
+PICOBENCH(format_dot<Q32_32>).label("dot_q32_32").iterations({1024, 65536});
+PICOBENCH(format_dot<Q16_16>).label("dot_q16_16").iterations({1024, 65536});
+
+
+// 刚体积分。场景只用 rng 的原始输出生成，各个标准库相同
+using fix64_math::RigidBodies;
+using fix64_math::RigidBody;
+using fix64_math::Vec3;
+
+static const int kIntegrateSteps = 8;
+
+static Fix64 RandomFix64(std::mt19937_64 &rng, int64_t range) {
+  return Fix64::FromRaw(int64_t(rng() % (uint64_t(2 * range) << kFracBit)) - (range << kFracBit));
+}
+
+static std::vector<RigidBody> Scene(size_t n) {
+  std::mt19937_64 rng(1);
+  std::vector<RigidBody> bodies(n);
+  for (RigidBody &b : bodies) {
+    b.position = {RandomFix64(rng, 1000), RandomFix64(rng, 1000), RandomFix64(rng, 1000)};
+    b.velocity = {RandomFix64(rng, 10), RandomFix64(rng, 10), RandomFix64(rng, 10)};
+    b.acceleration = {RandomFix64(rng, 1), RandomFix64(rng, 1) - Fix64(10), RandomFix64(rng, 1)};
+    Vec3 axis = fix64_math::Normalize(Vec3{RandomFix64(rng, 1), RandomFix64(rng, 1), RandomFix64(rng, 1)});
+    b.orientation = fix64_math::FromAxisAngle(axis, RandomFix64(rng, 3));
+    b.angularVelocity = {RandomFix64(rng, 2), RandomFix64(rng, 2), RandomFix64(rng, 2)};
+  }
+  return bodies;
+}
+
+// 每个版本、每个规模只打印一次
+static void ReportChecksum(const char *name, size_t n, uint64_t checksum) {
+  static const struct {
+    size_t bodies;
+    uint64_t checksum;
+  } kExpected[] = {{1024, 0x752648bbeff2a604ULL}, {65536, 0xb64aadc5516ea7d8ULL}};
+  static std::vector<std::pair<std::string, size_t>> reported;
+  if (std::find(reported.begin(), reported.end(), std::make_pair(std::string(name), n)) != reported.end())
+    return;
+  reported.emplace_back(name, n);
+  for (const auto &e : kExpected) {
+    if (e.bodies != n)
+      continue;
+    fprintf(stderr, "%s, %zu bodies x %d steps: checksum %016llx %s\n", name, n, kIntegrateSteps,
+            (unsigned long long)checksum, checksum == e.checksum ? "ok" : "MISMATCH");
+  }
+}
+
+static void integrate_aos(picobench::state &s) {
+  std::vector<RigidBody> bodies = Scene(s.iterations());
+  Fix64 dt = Fix64(1) / Fix64(60);
+  {
+    bench::perf_scope scope(s);
+    for (int step = 0; step < kIntegrateSteps; ++step)
+      for (RigidBody &b : bodies)
+        fix64_math::Integrate(&b, dt);
+  }
+  uint64_t checksum = fix64_math::Checksum(bodies.data(), bodies.size());
+  ReportChecksum("integrate_aos", bodies.size(), checksum);
+  s.set_result(uintptr_t(checksum));
+}
+
+template <fix64_batch::Isa isa>
+void integrate_soa(picobench::state &s) {
+  std::vector<RigidBody> scene = Scene(s.iterations());
+  RigidBodies bodies;
+  bodies.Resize(scene.size());
+  for (size_t i = 0; i < scene.size(); ++i)
+    bodies.Set(i, scene[i]);
+  Fix64 dt = Fix64(1) / Fix64(60);
+  fix64_batch::Isa active = fix64_batch::ActiveIsa();
+  bool supported = fix64_batch::SetIsa(isa);
+  {
+    bench::perf_scope scope(s);
+    for (int step = 0; step < kIntegrateSteps; ++step)
+      fix64_math::Integrate(&bodies, dt);
+  }
+  fix64_batch::SetIsa(active);
+  uint64_t checksum = fix64_math::Checksum(bodies);
+  std::string name = std::string("integrate_soa_") + fix64_batch::IsaName(supported ? isa : active);
+  ReportChecksum(name.c_str(), bodies.Size(), checksum);
+  s.set_result(uintptr_t(checksum));
+}
+
+// ns/op 是一个刚体积分 kIntegrateSteps 步
+PICOBENCH_SUITE("integrate");
+PICOBENCH(integrate_aos).iterations({1024, 65536}).baseline();
+PICOBENCH(integrate_soa<Isa::kScalar>).label("integrate_soa_scalar").iterations({1024, 65536});
+PICOBENCH(integrate_soa<Isa::kAvx2>).label("integrate_soa_avx2").iterations({1024, 65536});
+PICOBENCH(integrate_soa<Isa::kAvx512>).label("integrate_soa_avx512").iterations({1024, 65536});
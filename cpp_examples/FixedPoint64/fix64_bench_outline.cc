@@ -0,0 +1,20 @@
+// fix64_bench 的 inline 套件使用：运算符的不内联版本，相当于 Fix64 还在 Fix64.cc 里实现的时候，
+// 每个运算都是一次跨编译单元的函数调用。声明在 fix64_bench.cc 里
+
+#include "Fix64.h"
+
+#if defined(_MSC_VER)
+#define FIX64_NOINLINE __declspec(noinline)
+#else
+#define FIX64_NOINLINE __attribute__((noinline))
+#endif
+
+namespace fix64_outline {
+
+FIX64_NOINLINE Fix64 Add(const Fix64 &a, const Fix64 &b) { return a + b; }
+FIX64_NOINLINE Fix64 Mul(const Fix64 &a, const Fix64 &b) { return a * b; }
+FIX64_NOINLINE Fix64 SafeAdd(const Fix64 &a, const Fix64 &b) { return a.SafeAdd(b); }
+FIX64_NOINLINE Fix64 Abs(const Fix64 &a) { return a.Abs(); }
+FIX64_NOINLINE bool Less(const Fix64 &a, const Fix64 &b) { return a < b; }
+
+} // namespace fix64_outline
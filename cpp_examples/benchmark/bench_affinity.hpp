@@ -0,0 +1,52 @@
+// Lets a multi-threaded case use every core while the rest stay pinned.
+//
+// picobench pins the benchmark thread to the first core unless
+// PICOBENCH_DONT_BIND_TO_ONE_CORE is defined, and on Linux new threads
+// inherit that mask, so a parallel sort would run all its workers on one
+// core. Defining the macro unpins every case in the file instead. Put a
+// bench::all_cores_scope around just the parallel work: it restores the
+// mask the process started with and pins the thread again on exit.
+// Windows threads inherit the process mask rather than the thread's, and
+// macOS affinity is only a hint, so elsewhere the scope does nothing.
+
+#pragma once
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace bench {
+
+#if defined(__linux__)
+// Cores the process may run on, read during static initialization, before
+// picobench pins the main thread
+inline const cpu_set_t startup_cores = [] {
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    sched_getaffinity(0, sizeof(cores), &cores);
+    return cores;
+}();
+#endif
+
+class all_cores_scope {
+  public:
+#if defined(__linux__)
+    all_cores_scope() {
+        sched_getaffinity(0, sizeof(_pinned), &_pinned);
+        sched_setaffinity(0, sizeof(startup_cores), &startup_cores);
+    }
+    ~all_cores_scope() { sched_setaffinity(0, sizeof(_pinned), &_pinned); }
+#else
+    all_cores_scope() {}
+#endif
+
+    all_cores_scope(const all_cores_scope &) = delete;
+    all_cores_scope &operator=(const all_cores_scope &) = delete;
+
+#if defined(__linux__)
+  private:
+    cpu_set_t _pinned;
+#endif
+};
+
+} // namespace bench
@@ -0,0 +1,180 @@
+// Optional hardware performance counters for picobench scopes (Linux only).
+//
+// Use bench::perf_scope where a benchmark would use picobench::scope. When
+// the runner is started with --perf, every scope also records cycles,
+// instructions, L1d read misses, LLC misses and branch misses through
+// perf_event_open, and bench_runner.hpp prints them per operation next to
+// ns/op. Without --perf, on other platforms, or when the kernel refuses the
+// counters (perf_event_paranoid, containers, VMs without a virtual PMU) the
+// scope behaves exactly like picobench::scope; a counter the PMU lacks is
+// left out while the others keep working.
+//
+// Counters are opened with `inherit`, so threads spawned inside the scope
+// (ParallelRadixSort) are counted once they have been joined.
+
+#pragma once
+
+// picobench's implementation part has no include guard
+#if !defined(PICOBENCH_HPP_INCLUDED)
+#include "picobench.hpp"
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+enum perf_counter_id {
+    perf_cycles,
+    perf_instructions,
+    perf_l1d_misses,
+    perf_llc_misses,
+    perf_branch_misses,
+    perf_counter_count
+};
+
+inline const char *perf_counter_name(int id) {
+    static const char *names[perf_counter_count] = {"cycles", "instructions", "l1d_misses",
+                                                    "llc_misses", "branch_misses"};
+    return names[id];
+}
+
+class perf_counters {
+  public:
+    perf_counters() {
+        for (auto &fd : _fds) fd = -1;
+    }
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+    ~perf_counters() { close_all(); }
+
+    // Opens the counters; returns false if none of them could be opened,
+    // the reason is then available from error()
+    bool open() {
+#if defined(__linux__)
+        close_all();
+        const struct {
+            uint32_t type;
+            uint64_t config;
+        } events[perf_counter_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        int opened = 0;
+        for (int i = 0; i < perf_counter_count; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            // user space only: allowed up to perf_event_paranoid = 2
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // more events than PMU counters get multiplexed, scale them back
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            _fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (_fds[i] >= 0) {
+                ++opened;
+            } else if (_error.empty()) {
+                _error = std::string(perf_counter_name(i)) + ": " + std::strerror(errno);
+            }
+        }
+        return opened > 0;
+#else
+        _error = "hardware counters are only supported on Linux";
+        return false;
+#endif
+    }
+
+    bool available(int id) const { return _fds[id] >= 0; }
+    const std::string &error() const { return _error; }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : _fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Stops counting and returns one value per perf_counter_id,
+    // -1 for counters that are not available
+    std::vector<int64_t> stop() {
+        std::vector<int64_t> values(perf_counter_count, -1);
+#if defined(__linux__)
+        for (int fd : _fds) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int i = 0; i < perf_counter_count; ++i) {
+            if (_fds[i] < 0) continue;
+            uint64_t data[3] = {}; // value, time enabled, time running
+            if (read(_fds[i], data, sizeof(data)) != ssize_t(sizeof(data)) || data[2] == 0) continue;
+            double scale = data[2] < data[1] ? double(data[1]) / double(data[2]) : 1.0;
+            values[i] = int64_t(double(data[0]) * scale);
+        }
+#endif
+        return values;
+    }
+
+  private:
+    void close_all() {
+#if defined(__linux__)
+        for (auto &fd : _fds) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+    int _fds[perf_counter_count];
+    std::string _error;
+};
+
+// The counters used by perf_scope, nullptr unless enabled with --perf
+inline perf_counters *&active_perf_counters() {
+    static perf_counters *counters = nullptr;
+    return counters;
+}
+
+// Drop-in replacement for picobench::scope that also records counters
+class perf_scope {
+  public:
+    PICOBENCH_INLINE
+    explicit perf_scope(picobench::state &s) : _state(s), _counters(active_perf_counters()) {
+        if (_counters) _counters->start();
+        _state.start_timer();
+    }
+
+    PICOBENCH_INLINE
+    ~perf_scope() {
+        _state.stop_timer();
+        if (_counters) _state.set_counters(_counters->stop());
+    }
+
+    perf_scope(const perf_scope &) = delete;
+    perf_scope &operator=(const perf_scope &) = delete;
+
+  private:
+    picobench::state &_state;
+    perf_counters *_counters;
+};
+
+} // namespace bench
@@ -0,0 +1,563 @@
+// Regression-tracking front end for picobench.
+//
+// Adds to the usual picobench command line:
+//   --json=<file>        write every sample plus median/stddev and host,
+//                        compiler and build metadata as JSON
+//   --label=<text>       free-form tag stored in the JSON (e.g. a commit id)
+//   --compare=<file>     compare medians against a JSON file written by
+//                        --json and exit with 1 if any case got slower
+//   --threshold=<pct>    allowed slowdown for --compare, default 10
+//   --perf               record hardware counters in bench::perf_scope and
+//                        print them per operation (see bench_perf.hpp)
+//
+// Typical CI use:
+//   sort_bench --samples=5 --json=base.json            (on the base commit)
+//   sort_bench --samples=5 --compare=base.json         (on the change)
+//
+// Use it instead of PICOBENCH_IMPLEMENT_WITH_MAIN:
+//   #define BENCH_RUNNER_IMPLEMENT_MAIN
+//   #include "bench_runner.hpp"
+// Only the median is compared: with few samples it is far less sensitive to
+// a single preempted run than the fastest sample or the mean.
+
+#pragma once
+
+#if defined(BENCH_RUNNER_IMPLEMENT_MAIN) && !defined(PICOBENCH_IMPLEMENT)
+#define PICOBENCH_IMPLEMENT
+#endif
+#include "picobench.hpp"
+#include "bench_perf.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+struct sample_stats {
+    int64_t min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double stddev_ns = 0;
+};
+
+inline sample_stats compute_stats(std::vector<int64_t> samples) {
+    sample_stats st;
+    if (samples.empty()) return st;
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    st.min_ns = samples.front();
+    st.median_ns = (n & 1) ? double(samples[n / 2])
+                           : 0.5 * (double(samples[n / 2 - 1]) + double(samples[n / 2]));
+    double sum = 0;
+    for (auto s : samples) sum += double(s);
+    st.mean_ns = sum / double(n);
+    double var = 0;
+    for (auto s : samples) var += (double(s) - st.mean_ns) * (double(s) - st.mean_ns);
+    // sample standard deviation
+    st.stddev_ns = n > 1 ? std::sqrt(var / double(n - 1)) : 0.0;
+    return st;
+}
+
+inline std::string json_escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+inline std::string host_name() {
+#if defined(_WIN32)
+    char buf[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD size = sizeof(buf);
+    if (GetComputerNameA(buf, &size)) return std::string(buf, size);
+    return "unknown";
+#else
+    char buf[256] = {};
+    if (gethostname(buf, sizeof(buf) - 1) == 0) return buf;
+    return "unknown";
+#endif
+}
+
+inline std::string os_name() {
+#if defined(_WIN32)
+    return "Windows";
+#else
+    utsname u;
+    if (uname(&u) == 0) return std::string(u.sysname) + " " + u.release + " " + u.machine;
+    return "unknown";
+#endif
+}
+
+inline std::string compiler_name() {
+    std::ostringstream os;
+#if defined(__clang__)
+    os << "clang " << __clang_major__ << '.' << __clang_minor__ << '.' << __clang_patchlevel__;
+#elif defined(__GNUC__)
+    os << "gcc " << __GNUC__ << '.' << __GNUC_MINOR__ << '.' << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+    os << "msvc " << _MSC_FULL_VER;
+#else
+    os << "unknown";
+#endif
+    return os.str();
+}
+
+inline std::string utc_now() {
+    std::time_t t = std::time(nullptr);
+    std::tm tm{};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+inline std::string case_key(const char *suite, const char *name, int dimension) {
+    std::ostringstream os;
+    os << (suite ? suite : "") << '/' << name << '@' << dimension;
+    return os.str();
+}
+
+// Counters of the fastest sample, the one picobench reports; nullptr if
+// the benchmark did not record any
+inline const std::vector<int64_t> *fastest_counters(const picobench::report::benchmark_problem_space &d) {
+    const std::vector<int64_t> *best = nullptr;
+    int64_t bestTime = 0;
+    for (size_t i = 0; i < d.sample_times_ns.size() && i < d.sample_counters.size(); ++i) {
+        if (d.sample_counters[i].size() != perf_counter_count) continue;
+        if (!best || d.sample_times_ns[i] < bestTime) {
+            best = &d.sample_counters[i];
+            bestTime = d.sample_times_ns[i];
+        }
+    }
+    return best;
+}
+
+// Second table next to picobench's: counters per operation of the fastest
+// sample, `-` where a counter is not available
+inline void write_perf_table(const picobench::report &rpt, std::ostream &out) {
+    using namespace std;
+    for (auto &suite : rpt.suites) {
+        bool any = false;
+        for (auto &bm : suite.benchmarks)
+            for (auto &d : bm.data) any = any || fastest_counters(d);
+        if (!any) continue;
+        if (suite.name) out << "## " << suite.name << " (hardware counters):\n";
+        out << "\n Name                     |   Dim   |  ns/op  |  cyc/op |  IPC  | L1d miss/op | LLC miss/op | br miss/op\n"
+            << "--------------------------|--------:|--------:|--------:|------:|------------:|------------:|----------:\n";
+        auto perOp = [&](const vector<int64_t> &c, int id, int dim, int width, int precision) {
+            if (c[id] < 0)
+                out << setw(width) << '-';
+            else
+                out << setw(width) << fixed << setprecision(precision) << double(c[id]) / dim;
+            out << " |";
+        };
+        for (auto &bm : suite.benchmarks) {
+            for (auto &d : bm.data) {
+                auto c = fastest_counters(d);
+                if (!c) continue;
+                out << ' ' << left << setw(24) << bm.name << right << " |" << setw(8) << d.dimension << " |"
+                    << setw(8) << d.total_time_ns / d.dimension << " |";
+                perOp(*c, perf_cycles, d.dimension, 8, 1);
+                if ((*c)[perf_cycles] > 0 && (*c)[perf_instructions] >= 0)
+                    out << setw(6) << fixed << setprecision(2)
+                        << double((*c)[perf_instructions]) / double((*c)[perf_cycles]) << " |";
+                else
+                    out << setw(6) << '-' << " |";
+                perOp(*c, perf_l1d_misses, d.dimension, 12, 3);
+                perOp(*c, perf_llc_misses, d.dimension, 12, 3);
+                if ((*c)[perf_branch_misses] < 0)
+                    out << setw(10) << '-';
+                else
+                    out << setw(10) << fixed << setprecision(3) << double((*c)[perf_branch_misses]) / d.dimension;
+                out << '\n';
+            }
+        }
+        out << '\n';
+    }
+}
+
+inline void write_json(const picobench::report &rpt, std::ostream &out, const std::string &label) {
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << utc_now() << "\",\n"
+        << "    \"host\": \"" << json_escape(host_name()) << "\",\n"
+        << "    \"os\": \"" << json_escape(os_name()) << "\",\n"
+        << "    \"compiler\": \"" << json_escape(compiler_name()) << "\",\n"
+#if defined(NDEBUG)
+        << "    \"build\": \"release\",\n"
+#else
+        << "    \"build\": \"debug\",\n"
+#endif
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"picobench\": \"" << PICOBENCH_VERSION_STR << "\",\n"
+        << "    \"label\": \"" << json_escape(label) << "\"\n"
+        << "  },\n  \"benchmarks\": [";
+
+    const char *sep = "\n";
+    for (auto &suite : rpt.suites) {
+        for (auto &bm : suite.benchmarks) {
+            for (auto &d : bm.data) {
+                auto st = compute_stats(d.sample_times_ns);
+                out << sep << "    {\"suite\": ";
+                if (suite.name)
+                    out << '"' << json_escape(suite.name) << '"';
+                else
+                    out << "null";
+                out << ", \"name\": \"" << json_escape(bm.name) << "\""
+                    << ", \"baseline\": " << (bm.is_baseline ? "true" : "false")
+                    << ", \"dimension\": " << d.dimension
+                    << ",\n     \"samples_ns\": [";
+                for (size_t i = 0; i < d.sample_times_ns.size(); ++i)
+                    out << (i ? ", " : "") << d.sample_times_ns[i];
+                out << "],\n     \"min_ns\": " << st.min_ns << std::fixed << std::setprecision(1)
+                    << ", \"median_ns\": " << st.median_ns
+                    << ", \"mean_ns\": " << st.mean_ns
+                    << ", \"stddev_ns\": " << st.stddev_ns
+                    << ", \"median_ns_per_op\": " << std::setprecision(3)
+                    << st.median_ns / double(d.dimension);
+                out.unsetf(std::ios::floatfield);
+                if (auto c = fastest_counters(d)) {
+                    out << ",\n     \"counters\": {";
+                    const char *csep = "";
+                    for (int i = 0; i < perf_counter_count; ++i) {
+                        if ((*c)[i] < 0) continue;
+                        out << csep << '"' << perf_counter_name(i) << "\": " << (*c)[i];
+                        csep = ", ";
+                    }
+                    out << '}';
+                }
+                out << '}';
+                sep = ",\n";
+            }
+        }
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Just enough of a JSON reader for files written by write_json
+class json_value {
+  public:
+    enum kind_t { null_v, bool_v, number_v, string_v, array_v, object_v };
+
+    kind_t kind = null_v;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<json_value> array;
+    std::map<std::string, json_value> object;
+
+    const json_value *find(const char *key) const {
+        auto it = object.find(key);
+        return it == object.end() ? nullptr : &it->second;
+    }
+
+    // returns false on malformed input
+    static bool parse(const std::string &text, json_value &out) {
+        const char *p = text.c_str();
+        if (!parse_value(p, out)) return false;
+        skip_ws(p);
+        return *p == '\0';
+    }
+
+  private:
+    static void skip_ws(const char *&p) {
+        while (*p && std::isspace(static_cast<unsigned char>(*p))) ++p;
+    }
+
+    static bool parse_string(const char *&p, std::string &out) {
+        if (*p != '"') return false;
+        ++p;
+        while (*p && *p != '"') {
+            if (*p == '\\') {
+                ++p;
+                switch (*p) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    // only ever written for control characters
+                    char hex[5] = {};
+                    for (int i = 0; i < 4; ++i) {
+                        if (!p[1 + i]) return false;
+                        hex[i] = p[1 + i];
+                    }
+                    out += char(std::strtol(hex, nullptr, 16));
+                    p += 4;
+                    break;
+                }
+                case '\0': return false;
+                default: out += *p; break;
+                }
+                ++p;
+            } else {
+                out += *p++;
+            }
+        }
+        if (*p != '"') return false;
+        ++p;
+        return true;
+    }
+
+    static bool parse_value(const char *&p, json_value &out) {
+        skip_ws(p);
+        if (*p == '{') {
+            out.kind = object_v;
+            ++p;
+            skip_ws(p);
+            if (*p == '}') { ++p; return true; }
+            while (true) {
+                skip_ws(p);
+                std::string key;
+                if (!parse_string(p, key)) return false;
+                skip_ws(p);
+                if (*p++ != ':') return false;
+                if (!parse_value(p, out.object[key])) return false;
+                skip_ws(p);
+                if (*p == ',') { ++p; continue; }
+                if (*p == '}') { ++p; return true; }
+                return false;
+            }
+        }
+        if (*p == '[') {
+            out.kind = array_v;
+            ++p;
+            skip_ws(p);
+            if (*p == ']') { ++p; return true; }
+            while (true) {
+                out.array.emplace_back();
+                if (!parse_value(p, out.array.back())) return false;
+                skip_ws(p);
+                if (*p == ',') { ++p; continue; }
+                if (*p == ']') { ++p; return true; }
+                return false;
+            }
+        }
+        if (*p == '"') {
+            out.kind = string_v;
+            return parse_string(p, out.string);
+        }
+        if (std::strncmp(p, "true", 4) == 0) { out.kind = bool_v; out.boolean = true; p += 4; return true; }
+        if (std::strncmp(p, "false", 5) == 0) { out.kind = bool_v; p += 5; return true; }
+        if (std::strncmp(p, "null", 4) == 0) { out.kind = null_v; p += 4; return true; }
+        char *end = nullptr;
+        out.number = std::strtod(p, &end);
+        if (end == p) return false;
+        out.kind = number_v;
+        p = end;
+        return true;
+    }
+};
+
+// Reads the median of every case from a file written by write_json.
+inline bool load_medians(const char *path, std::map<std::string, double> &medians, std::ostream &err) {
+    std::ifstream in(path);
+    if (!in) {
+        err << "Error: Could not open baseline file `" << path << "`\n";
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    json_value root;
+    if (!json_value::parse(ss.str(), root) || root.kind != json_value::object_v) {
+        err << "Error: `" << path << "` is not valid JSON\n";
+        return false;
+    }
+    auto benchmarks = root.find("benchmarks");
+    if (!benchmarks || benchmarks->kind != json_value::array_v) {
+        err << "Error: `" << path << "` has no benchmarks array\n";
+        return false;
+    }
+    for (auto &b : benchmarks->array) {
+        auto suite = b.find("suite");
+        auto name = b.find("name");
+        auto dim = b.find("dimension");
+        auto median = b.find("median_ns");
+        if (!name || !dim || !median) continue;
+        const char *suiteName = suite && suite->kind == json_value::string_v ? suite->string.c_str() : nullptr;
+        medians[case_key(suiteName, name->string.c_str(), int(dim->number))] = median->number;
+    }
+    return true;
+}
+
+// Prints every case found in both runs; returns the number of regressions.
+inline int compare_to_baseline(const picobench::report &rpt, const std::map<std::string, double> &baseline,
+                               double threshold_pct, std::ostream &out) {
+    int regressions = 0;
+    out << "\n Case                                     |  Base med ns |   New med ns |   Change\n"
+        << "------------------------------------------|-------------:|-------------:|--------:\n";
+    for (auto &suite : rpt.suites) {
+        for (auto &bm : suite.benchmarks) {
+            for (auto &d : bm.data) {
+                auto key = case_key(suite.name, bm.name, d.dimension);
+                auto it = baseline.find(key);
+                if (it == baseline.end() || it->second <= 0) continue;
+                double now = compute_stats(d.sample_times_ns).median_ns;
+                double change = (now / it->second - 1.0) * 100.0;
+                bool slower = change > threshold_pct;
+                regressions += slower;
+                out << ' ' << std::left << std::setw(40) << key << std::right << " |"
+                    << std::setw(13) << std::fixed << std::setprecision(0) << it->second << " |"
+                    << std::setw(13) << now << " |" << std::setw(7) << std::setprecision(1)
+                    << std::showpos << change << std::noshowpos << '%'
+                    << (slower ? "  REGRESSION" : "") << '\n';
+            }
+        }
+    }
+    out << '\n' << regressions << " case(s) slower than the baseline by more than "
+        << std::fixed << std::setprecision(1) << threshold_pct << "%\n";
+    return regressions;
+}
+
+struct runner_options {
+    const char *json_file = nullptr;
+    const char *compare_file = nullptr;
+    std::string label;
+    double threshold_pct = 10.0;
+    bool perf = false;
+};
+
+inline void add_cmd_opts(picobench::runner &r, runner_options &opts) {
+    auto data = reinterpret_cast<uintptr_t>(&opts);
+    r.add_cmd_opt("-json=", "<filename>", "Writes all samples and stats as JSON",
+                  [](uintptr_t o, const char *line) {
+                      if (!*line) return false;
+                      reinterpret_cast<runner_options *>(o)->json_file = line;
+                      return true;
+                  }, data);
+    r.add_cmd_opt("-label=", "<text>", "Label stored in the JSON output",
+                  [](uintptr_t o, const char *line) {
+                      reinterpret_cast<runner_options *>(o)->label = line;
+                      return true;
+                  }, data);
+    r.add_cmd_opt("-compare=", "<filename>", "Fails if slower than a --json baseline",
+                  [](uintptr_t o, const char *line) {
+                      if (!*line) return false;
+                      reinterpret_cast<runner_options *>(o)->compare_file = line;
+                      return true;
+                  }, data);
+    r.add_cmd_opt("-threshold=", "<percent>", "Allowed slowdown for --compare",
+                  [](uintptr_t o, const char *line) {
+                      char *end = nullptr;
+                      double pct = std::strtod(line, &end);
+                      if (end == line || pct < 0) return false;
+                      reinterpret_cast<runner_options *>(o)->threshold_pct = pct;
+                      return true;
+                  }, data);
+    r.add_cmd_opt("-perf", "", "Records hardware counters (Linux)",
+                  [](uintptr_t o, const char *line) {
+                      if (*line) return false;
+                      reinterpret_cast<runner_options *>(o)->perf = true;
+                      return true;
+                  }, data);
+}
+
+// Same as picobench::runner::run, plus the JSON output and the comparison.
+// Returns picobench's error code, or 1 if a case regressed.
+inline int run(picobench::runner &r, const runner_options &opts) {
+    if (!r.should_run()) return r.error();
+
+    std::map<std::string, double> baseline;
+    if (opts.compare_file && !load_medians(opts.compare_file, baseline, std::cerr)) return 1;
+
+    perf_counters counters;
+    bool perfActive = false;
+    if (opts.perf) {
+        perfActive = counters.open();
+        if (perfActive) {
+            active_perf_counters() = &counters;
+            for (int i = 0; i < perf_counter_count; ++i) {
+                if (!counters.available(i))
+                    std::cout << "Warning: counter " << perf_counter_name(i) << " is not available\n";
+            }
+        } else {
+            std::cout << "Warning: hardware counters unavailable (" << counters.error()
+                      << "), running without them\n";
+        }
+    }
+
+    r.run_benchmarks();
+    active_perf_counters() = nullptr;
+    auto rpt = r.generate_report();
+
+    std::ostream *out = &std::cout;
+    std::ofstream fout;
+    if (r.preferred_output_filename()) {
+        fout.open(r.preferred_output_filename());
+        if (!fout.is_open()) {
+            std::cerr << "Error: Could not open output file `" << r.preferred_output_filename() << "`\n";
+            return 1;
+        }
+        out = &fout;
+    }
+    switch (r.preferred_output_format()) {
+    case picobench::report_output_format::text: rpt.to_text(*out); break;
+    case picobench::report_output_format::concise_text: rpt.to_text_concise(*out); break;
+    case picobench::report_output_format::csv: rpt.to_csv(*out); break;
+    }
+    if (perfActive && r.preferred_output_format() != picobench::report_output_format::csv)
+        write_perf_table(rpt, *out);
+
+    if (opts.json_file) {
+        std::ofstream jout(opts.json_file);
+        if (!jout.is_open()) {
+            std::cerr << "Error: Could not open json file `" << opts.json_file << "`\n";
+            return 1;
+        }
+        write_json(rpt, jout, opts.label);
+    }
+
+    if (r.error() != picobench::no_error) return r.error();
+    if (opts.compare_file && compare_to_baseline(rpt, baseline, opts.threshold_pct, std::cout) > 0) return 1;
+    return 0;
+}
+
+} // namespace bench
+
+#if defined(BENCH_RUNNER_IMPLEMENT_MAIN)
+int main(int argc, char *argv[]) {
+    picobench::runner r;
+    bench::runner_options opts;
+    bench::add_cmd_opts(r, opts);
+    r.parse_cmd_line(argc, argv);
+    return bench::run(r, opts);
+}
+#endif
@@ -30,6 +30,12 @@
 //
 //                  VERSION HISTORY
 //
+//  local patch       * Keep every sample's duration in the report
+//                      (benchmark_problem_space::sample_times_ns) so
+//                      bench_runner.hpp can export and compare them
+//                    * Let a state carry hardware counter values
+//                      (state::set_counters) which end up next to each
+//                      sample in the report, see bench_perf.hpp
 //  2.07 (2024-03-06) * Text output is now markdown compatible
 //                    * Allow including picobench.hpp before defining
 //                      PICOBENCH_IMPLEMENT
@@ -122,6 +128,7 @@
 
 #include <cstdint>
 #include <chrono>
+#include <utility>
 #include <vector>
 
 #if defined(PICOBENCH_STD_FUNCTION_BENCHMARKS)
@@ -193,6 +200,10 @@ public:
     void set_result(uintptr_t data) { _result = data; }
     result_t result() const { return _result; }
 
+    // optional hardware counter values of the measured code
+    void set_counters(std::vector<int64_t> counters) { _counters = std::move(counters); }
+    const std::vector<int64_t>& counters() const { return _counters; }
+
     PICOBENCH_INLINE
     void start_timer()
     {
@@ -271,6 +282,7 @@ private:
     uintptr_t _user_data;
     int _iterations;
     result_t _result = 0;
+    std::vector<int64_t> _counters;
 };
 
 // this can be used for manual measurement
@@ -409,6 +421,8 @@ public:
         int samples; // number of samples taken
         int64_t total_time_ns; // fastest sample!!!
         result_t result; // result of fastest sample
+        std::vector<int64_t> sample_times_ns; // all samples, in run order
+        std::vector<std::vector<int64_t>> sample_counters; // state::counters() of each sample
     };
     struct benchmark
     {
@@ -1031,7 +1045,7 @@ public:
                 rpt_benchmark->data.reserve(state_iterations.size());
                 for (auto d : state_iterations)
                 {
-                    rpt_benchmark->data.push_back({d, 0, 0ll, result_t(0)});
+                    rpt_benchmark->data.push_back({d, 0, 0ll, result_t(0), {}, {}});
                 }
 
                 for (auto& state : b->_states)
@@ -1056,6 +1070,8 @@ public:
                                 }
                             }
 
+                            d.sample_times_ns.push_back(state.duration_ns());
+                            d.sample_counters.push_back(state.counters());
                             ++d.samples;
                         }
                     }
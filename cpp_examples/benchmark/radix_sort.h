@@ -0,0 +1,170 @@
+#pragma once
+// Templated LSD radix sort.
+// Unlike RadixSort in sort_bench.cc (30-bit uint32 only) this one sorts the
+// full width of 32/64-bit unsigned and signed integers and IEEE floats, and
+// can carry a payload by sorting records through a key extractor.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// RadixKey<K> maps a key to an unsigned integer of the same width whose
+// unsigned order matches the order of the original key.
+template <typename K, typename Enable = void>
+struct RadixKey;
+
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_integral_v<K> && std::is_unsigned_v<K>>> {
+    using Bits = K;
+    static Bits ToBits(K k) { return k; }
+};
+
+// two's complement: flipping the sign bit moves negatives below positives
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_integral_v<K> && std::is_signed_v<K>>> {
+    using Bits = std::make_unsigned_t<K>;
+    static Bits ToBits(K k) {
+        return Bits(k) ^ (Bits(1) << (sizeof(K) * 8 - 1));
+    }
+};
+
+// IEEE 754: positives only need the sign bit set, negatives are stored as
+// sign-magnitude so all bits are flipped to reverse their order.
+// -0.0 sorts right before +0.0, NaNs with the sign bit clear sort last.
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_floating_point_v<K>>> {
+    static_assert(sizeof(K) == 4 || sizeof(K) == 8, "Only float and double are supported");
+    using Bits = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+    static Bits ToBits(K k) {
+        Bits b;
+        std::memcpy(&b, &k, sizeof(K));
+        constexpr Bits signBit = Bits(1) << (sizeof(K) * 8 - 1);
+        Bits mask = (b & signBit) ? ~Bits(0) : signBit;
+        return b ^ mask;
+    }
+};
+
+struct RadixIdentity {
+    template <typename T>
+    const T &operator()(const T &v) const { return v; }
+};
+
+// Cache size in bytes of the given level (1 = L1d, 2 = L2), used to pick
+// the digit width. Falls back to common desktop values when unknown.
+inline size_t RadixCacheSize(int level) {
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    long size = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) return size_t(size);
+#endif
+    return level == 1 ? 32 * 1024 : 1024 * 1024;
+}
+
+// Picks 8, 11 or 16 bits per pass for n keys of keyBits bits.
+// A wider digit saves passes, but only pays off when
+//  - every bucket still gets a decent run of elements, otherwise the
+//    histogram work dominates, and
+//  - the scatter working set (one counter plus one partially written
+//    output cache line per bucket) stays in cache.
+// Among the widths that qualify, the narrowest one with the fewest passes
+// wins: 11 bits on a 16-bit key still needs two passes, same as 8 bits.
+inline int RadixDigitBits(size_t n, int keyBits) {
+    static const size_t l2 = RadixCacheSize(2);
+    constexpr size_t bytesPerBucket = sizeof(size_t) + 64;
+    constexpr size_t minPerBucket[] = {0, 64, 256};
+    constexpr int widths[] = {8, 11, 16};
+
+    int best = 8;
+    int bestPasses = (keyBits + 7) / 8;
+    for (int i = 1; i < 3; ++i) {
+        size_t nBuckets = size_t(1) << widths[i];
+        if (n < nBuckets * minPerBucket[i]) break;
+        // 16-bit digits can't keep an output line per bucket in L2;
+        // require at least the counters to fit there
+        size_t workingSet = nBuckets * (widths[i] == 16 ? sizeof(size_t) : bytesPerBucket);
+        if (workingSet > l2) break;
+        int passes = (keyBits + widths[i] - 1) / widths[i];
+        if (passes < bestPasses) {
+            best = widths[i];
+            bestPasses = passes;
+        }
+    }
+    return best;
+}
+
+// Sorts v by keyOf(element), where keyOf returns any type RadixKey handles.
+// The sort is stable, so records with equal keys keep their input order.
+//
+// The histograms of all passes are built in a single read of the input
+// before anything moves. A pass whose histogram puts every key in one
+// bucket would only copy the data, so it is skipped: keys confined to a
+// narrow range (e.g. timestamps within an hour) only pay for the digits
+// that actually vary.
+//
+// digitBits = 0 picks the width with RadixDigitBits, any other value in
+// [1, 16] forces it.
+template <typename T, typename KeyOf = RadixIdentity>
+void RadixSortBy(std::vector<T> *v, KeyOf keyOf = KeyOf(), int digitBits = 0) {
+    using Key = std::decay_t<decltype(keyOf(std::declval<const T &>()))>;
+    using Traits = RadixKey<Key>;
+    using Bits = typename Traits::Bits;
+
+    constexpr int nBits = sizeof(Bits) * 8;
+    const size_t n = v->size();
+    if (n < 2) return;
+
+    const int bitsPerPass = digitBits > 0 ? digitBits : RadixDigitBits(n, nBits);
+    const int nPasses = (nBits + bitsPerPass - 1) / bitsPerPass;
+    const size_t nBuckets = size_t(1) << bitsPerPass;
+    const Bits bitMask = Bits(nBuckets - 1);
+
+    // histogram of every pass in one read
+    std::vector<size_t> histograms(nPasses * nBuckets, 0);
+    for (const T &e : *v) {
+        Bits bits = Traits::ToBits(keyOf(e));
+        size_t *h = histograms.data();
+        for (int pass = 0; pass < nPasses; ++pass, h += nBuckets)
+            ++h[(bits >> (pass * bitsPerPass)) & bitMask];
+    }
+
+    std::vector<T> tempVector;
+    std::vector<T> *in = v;
+    std::vector<T> *out = &tempVector;
+    for (int pass = 0; pass < nPasses; ++pass) {
+        int lowBit = pass * bitsPerPass;
+        size_t *bucketCount = histograms.data() + pass * nBuckets;
+
+        // all keys share this digit, the pass would not reorder anything
+        Bits firstDigit = (Traits::ToBits(keyOf(in->front())) >> lowBit) & bitMask;
+        if (bucketCount[firstDigit] == n) continue;
+
+        if (tempVector.empty()) tempVector.resize(n);
+
+        // turn the counts into starting output indices in place
+        size_t sum = 0;
+        for (size_t i = 0; i < nBuckets; ++i) {
+            size_t c = bucketCount[i];
+            bucketCount[i] = sum;
+            sum += c;
+        }
+
+        T *outData = out->data();
+        for (T &e : *in)
+            outData[bucketCount[(Traits::ToBits(keyOf(e)) >> lowBit) & bitMask]++] = std::move(e);
+        std::swap(in, out);
+    }
+    // Copy final result from _tempVector_, if needed
+    if (in != v) std::swap(*v, tempVector);
+}
+
+// Sorts a vector of plain keys (uint32_t, int64_t, float, ...)
+template <typename K>
+void RadixSortKeys(std::vector<K> *v, int digitBits = 0) {
+    RadixSortBy(v, RadixIdentity(), digitBits);
+}
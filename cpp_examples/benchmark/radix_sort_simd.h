@@ -0,0 +1,205 @@
+#pragma once
+// uint32 LSD radix sort with hand-tuned histogram and scatter kernels.
+//
+// Histogram: the plain `++bucketCount[bucket]` loop stalls whenever two
+// nearby keys hit the same bucket, because the second increment has to wait
+// for the first store to be forwarded. Spreading consecutive keys over four
+// sub-histograms breaks those chains; they are summed afterwards. With AVX2
+// the digits of eight keys for all four passes are extracted at once.
+//
+// Scatter: writing every key straight to one of 256 output streams touches a
+// different cache line almost every store. Keys are staged in a 64-byte
+// write-combining buffer per bucket instead and copied out a full cache line
+// at a time.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RADIX_SIMD_X86 1
+#define RADIX_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#define RADIX_SIMD_X86 1
+#define RADIX_TARGET_AVX2
+#endif
+
+namespace radix_simd {
+
+constexpr int kBitsPerPass = 8;
+constexpr int kPasses = 32 / kBitsPerPass;
+constexpr int kBuckets = 1 << kBitsPerPass;
+constexpr int kSubHistograms = 4;
+constexpr int kLineElements = 64 / sizeof(uint32_t);
+
+using Histograms = uint32_t[kPasses][kBuckets];
+
+inline bool HasAVX2() {
+#if defined(RADIX_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+    static const bool hasAVX2 = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // OSXSAVE and the OS saving the YMM state
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return hasAVX2;
+#elif defined(RADIX_SIMD_X86)
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+#else
+    return false;
+#endif
+}
+
+// Histograms of all passes, key i goes to sub-histogram i % 4
+inline void HistogramScalar(const uint32_t *keys, size_t n, Histograms &out) {
+    uint32_t sub[kSubHistograms][kPasses][kBuckets] = {};
+
+    size_t i = 0;
+    for (; i + kSubHistograms <= n; i += kSubHistograms) {
+        for (int s = 0; s < kSubHistograms; ++s) {
+            uint32_t key = keys[i + s];
+            for (int pass = 0; pass < kPasses; ++pass)
+                ++sub[s][pass][(key >> (pass * kBitsPerPass)) & (kBuckets - 1)];
+        }
+    }
+    for (; i < n; ++i)
+        for (int pass = 0; pass < kPasses; ++pass)
+            ++sub[0][pass][(keys[i] >> (pass * kBitsPerPass)) & (kBuckets - 1)];
+
+    for (int pass = 0; pass < kPasses; ++pass)
+        for (int b = 0; b < kBuckets; ++b)
+            out[pass][b] = sub[0][pass][b] + sub[1][pass][b] + sub[2][pass][b] + sub[3][pass][b];
+}
+
+#if defined(RADIX_SIMD_X86)
+RADIX_TARGET_AVX2
+inline void HistogramAVX2(const uint32_t *keys, size_t n, Histograms &out) {
+    uint32_t sub[kSubHistograms][kPasses][kBuckets] = {};
+
+    const __m256i mask = _mm256_set1_epi32(kBuckets - 1);
+    alignas(32) uint32_t digits[kPasses][8];
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(digits[0]), _mm256_and_si256(k, mask));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(digits[1]),
+                           _mm256_and_si256(_mm256_srli_epi32(k, 8), mask));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(digits[2]),
+                           _mm256_and_si256(_mm256_srli_epi32(k, 16), mask));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(digits[3]), _mm256_srli_epi32(k, 24));
+        for (int pass = 0; pass < kPasses; ++pass) {
+            for (int j = 0; j < 8; ++j)
+                ++sub[j & (kSubHistograms - 1)][pass][digits[pass][j]];
+        }
+    }
+    for (; i < n; ++i)
+        for (int pass = 0; pass < kPasses; ++pass)
+            ++sub[0][pass][(keys[i] >> (pass * kBitsPerPass)) & (kBuckets - 1)];
+
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (int b = 0; b < kBuckets; b += 8) {
+            __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&sub[0][pass][b]));
+            __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&sub[1][pass][b]));
+            __m256i s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&sub[2][pass][b]));
+            __m256i s3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&sub[3][pass][b]));
+            __m256i sum = _mm256_add_epi32(_mm256_add_epi32(s0, s1), _mm256_add_epi32(s2, s3));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&out[pass][b]), sum);
+        }
+    }
+}
+#endif
+
+// Scatters in[0, n) by the digit at lowBit. start[b] is the first output
+// index of bucket b. Slots are grouped by address, not by index: out comes
+// from a std::vector and need not be 64-byte aligned, so positions are
+// counted from the cache line that holds out[0] (skew elements before it).
+// Slot j of a bucket's buffer holds the key whose position is congruent to
+// j mod 16, so a full buffer always maps to exactly one 64-byte line of the
+// output; only a bucket's first and last lines can be partial, and those
+// are copied element-wise.
+inline void ScatterWriteCombined(const uint32_t *in, uint32_t *out, size_t n, int lowBit,
+                                 const uint32_t start[kBuckets]) {
+    alignas(64) uint32_t buffer[kBuckets][kLineElements];
+    const size_t skew = (reinterpret_cast<uintptr_t>(out) / sizeof(uint32_t)) & (kLineElements - 1);
+    size_t first[kBuckets], pos[kBuckets];
+    for (int b = 0; b < kBuckets; ++b) pos[b] = first[b] = start[b] + skew;
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t key = in[i];
+        int b = (key >> lowBit) & (kBuckets - 1);
+        size_t p = pos[b]++;
+        buffer[b][p & (kLineElements - 1)] = key;
+        if ((p & (kLineElements - 1)) == kLineElements - 1) {
+            size_t lineBegin = p + 1 - kLineElements;
+            if (lineBegin >= first[b]) {
+                std::memcpy(out + (lineBegin - skew), buffer[b], sizeof(buffer[b]));
+            } else {
+                size_t offset = first[b] - lineBegin;
+                std::memcpy(out + (first[b] - skew), buffer[b] + offset,
+                            (kLineElements - offset) * sizeof(uint32_t));
+            }
+        }
+    }
+
+    // whatever is left in the buffers is the partial tail of each bucket
+    for (int b = 0; b < kBuckets; ++b) {
+        size_t end = pos[b];
+        size_t lineBegin = end & ~size_t(kLineElements - 1);
+        if (end == lineBegin) continue;
+        size_t from = lineBegin > first[b] ? lineBegin : first[b];
+        std::memcpy(out + (from - skew), buffer[b] + (from - lineBegin), (end - from) * sizeof(uint32_t));
+    }
+}
+
+} // namespace radix_simd
+
+// Sorts full 32-bit keys with four 8-bit passes. Trivial passes (all keys in
+// one bucket) are skipped like in RadixSortBy. allowAVX2 = false forces the
+// scalar histogram so both kernels can be compared on the same machine.
+inline void RadixSortSIMD(std::vector<uint32_t> *v, bool allowAVX2 = true) {
+    using namespace radix_simd;
+    const size_t n = v->size();
+    if (n < 2) return;
+    assert(n <= UINT32_MAX);
+
+    Histograms histograms;
+#if defined(RADIX_SIMD_X86)
+    if (allowAVX2 && HasAVX2())
+        HistogramAVX2(v->data(), n, histograms);
+    else
+#endif
+        HistogramScalar(v->data(), n, histograms);
+    (void)allowAVX2;
+
+    std::vector<uint32_t> tempVector;
+    std::vector<uint32_t> *in = v;
+    std::vector<uint32_t> *out = &tempVector;
+    for (int pass = 0; pass < kPasses; ++pass) {
+        int lowBit = pass * kBitsPerPass;
+        uint32_t *bucketCount = histograms[pass];
+        if (bucketCount[(in->front() >> lowBit) & (kBuckets - 1)] == n) continue;
+
+        if (tempVector.empty()) tempVector.resize(n);
+
+        uint32_t sum = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            uint32_t c = bucketCount[b];
+            bucketCount[b] = sum;
+            sum += c;
+        }
+        ScatterWriteCombined(in->data(), out->data(), n, lowBit, bucketCount);
+        std::swap(in, out);
+    }
+    if (in != v) std::swap(*v, tempVector);
+}
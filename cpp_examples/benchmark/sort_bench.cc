@@ -1,10 +1,17 @@
 #define PICOBENCH_DEBUG
-#define PICOBENCH_IMPLEMENT_WITH_MAIN
-#include "picobench.hpp"
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+#include "bench_affinity.hpp"
+#include "radix_sort.h"
+#include "radix_sort_simd.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
 #include <deque>
+#include <mutex>
 #include <random>
+#include <thread>
 
 std::vector<uint32_t> InitVector(int size) {
   std::seed_seq seed{1234};
@@ -29,6 +36,81 @@ void CheckSorted(const std::vector<uint32_t> &v) {
   }
 }
 
+// (uint64 key, uint32 payload) records
+struct KeyValue64 {
+  uint64_t key;
+  uint32_t value;
+};
+
+std::vector<KeyValue64> InitKeyValues(int size) {
+  std::seed_seq seed{1234};
+  std::mt19937_64 gen(seed);
+  std::vector<KeyValue64> v;
+  v.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    v.push_back({gen(), uint32_t(i)});
+  }
+  return v;
+}
+
+// depth-like float keys, both signs
+std::vector<float> InitFloats(int size) {
+  std::seed_seq seed{1234};
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dis(-1000.0f, 1000.0f);
+  std::vector<float> v;
+  v.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    v.push_back(dis(gen));
+  }
+  return v;
+}
+
+// Non-uniform inputs, selected through the benchmark's user_data. All stay
+// below 2^30 so the original RadixSort can sort them as well.
+enum Distribution : uintptr_t {
+  kPresorted,  // InitVector data, already sorted
+  kLowEntropy, // AND of four uniform values: each bit is set with p = 1/16
+};
+
+std::vector<uint32_t> InitDistribution(int size, uintptr_t dist) {
+  std::vector<uint32_t> v = InitVector(size);
+  if (dist == kPresorted) {
+    std::sort(v.begin(), v.end());
+  } else if (dist == kLowEntropy) {
+    std::seed_seq seed{4321};
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint32_t> dis(0, (1 << 30) - 1);
+    for (auto &x : v) {
+      x &= dis(gen) & dis(gen) & dis(gen);
+    }
+  }
+  return v;
+}
+
+// uint64 millisecond timestamps within one hour: only the low 22 bits vary
+std::vector<uint64_t> InitTimestamps(int size) {
+  std::seed_seq seed{1234};
+  std::mt19937_64 gen(seed);
+  const uint64_t start = 1700000000000ull;
+  std::uniform_int_distribution<uint64_t> dis(0, 3600 * 1000 - 1);
+  std::vector<uint64_t> v;
+  v.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    v.push_back(start + dis(gen));
+  }
+  return v;
+}
+
+template <typename T, typename Less = std::less<T>>
+void CheckSorted(const std::vector<T> &v, Less less = Less()) {
+  if (!std::is_sorted(std::begin(v), std::end(v), less)) {
+    std::cout << "Error: data is not sorted" << std::endl;
+  }
+}
+
+static bool KeyLess(const KeyValue64 &a, const KeyValue64 &b) { return a.key < b.key; }
+
 
 #define PBRT_CONSTEXPR constexpr
 static void RadixSort(std::vector<uint32_t> *v) {
@@ -76,10 +158,120 @@ static void RadixSort(std::vector<uint32_t> *v) {
     if (nPasses & 1) std::swap(*v, tempVector);
 }
 
+// Reusable barrier for the worker threads of ParallelRadixSort
+// (std::barrier is C++20)
+class ThreadBarrier {
+  public:
+    explicit ThreadBarrier(int count) : count_(count), waiting_(0), generation_(0) {}
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        int generation = generation_;
+        if (++waiting_ == count_) {
+            waiting_ = 0;
+            ++generation_;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [&] { return generation != generation_; });
+        }
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    const int count_;
+    int waiting_;
+    int generation_;
+};
+
+// Same 30-bit LSD radix sort as RadixSort, split across threads.
+// Every thread owns a contiguous chunk of the input and keeps its own
+// histogram, so the counting step needs no atomics. After all threads have
+// counted, one thread turns the nThreads x nBuckets histograms into the
+// starting output index of every (bucket, thread) pair:
+//   offset[t][b] = sum(count[*][0..b-1]) + sum(count[0..t-1][b])
+// Each thread then scatters its own chunk to its own disjoint ranges, which
+// also keeps the sort stable as LSD radix sort requires.
+static void ParallelRadixSort(std::vector<uint32_t> *v, int nThreads = 0) {
+    PBRT_CONSTEXPR int bitsPerPass = 6;
+    PBRT_CONSTEXPR int nBits = 30;
+    static_assert((nBits % bitsPerPass) == 0,
+                  "Radix sort bitsPerPass must evenly divide nBits");
+    PBRT_CONSTEXPR int nPasses = nBits / bitsPerPass;
+    PBRT_CONSTEXPR int nBuckets = 1 << bitsPerPass;
+    PBRT_CONSTEXPR int bitMask = (1 << bitsPerPass) - 1;
+    // Below this many elements per thread the spawn and the barriers cost
+    // more than the pass itself
+    PBRT_CONSTEXPR size_t minElementsPerThread = 1 << 14;
+
+    const size_t n = v->size();
+    if (nThreads <= 0) nThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    nThreads = int(std::min<size_t>(nThreads, std::max<size_t>(1, n / minElementsPerThread)));
+    if (nThreads == 1) {
+        RadixSort(v);
+        return;
+    }
+
+    std::vector<uint32_t> tempVector(n);
+    // one cache line apart so threads don't false-share histogram rows
+    struct alignas(64) ThreadCounts {
+        size_t count[nBuckets];
+    };
+    std::vector<ThreadCounts> counts(nThreads);
+    ThreadBarrier barrier(nThreads);
+
+    auto worker = [&](int t) {
+        const size_t begin = n * t / nThreads;
+        const size_t end = n * (t + 1) / nThreads;
+        size_t *bucketCount = counts[t].count;
+
+        for (int pass = 0; pass < nPasses; ++pass) {
+            int lowBit = pass * bitsPerPass;
+            const uint32_t *in = (pass & 1) ? tempVector.data() : v->data();
+            uint32_t *out = (pass & 1) ? v->data() : tempVector.data();
+
+            // per-thread histogram of this thread's chunk
+            std::fill(bucketCount, bucketCount + nBuckets, size_t(0));
+            for (size_t i = begin; i < end; ++i)
+                ++bucketCount[(in[i] >> lowBit) & bitMask];
+            barrier.Wait();
+
+            // exclusive prefix sum over (bucket, thread), in place
+            if (t == 0) {
+                size_t sum = 0;
+                for (int b = 0; b < nBuckets; ++b) {
+                    for (int j = 0; j < nThreads; ++j) {
+                        size_t c = counts[j].count[b];
+                        counts[j].count[b] = sum;
+                        sum += c;
+                    }
+                }
+            }
+            barrier.Wait();
+
+            // bucketCount now holds this thread's output index per bucket
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t mp = in[i];
+                out[bucketCount[(mp >> lowBit) & bitMask]++] = mp;
+            }
+            // the next pass reads what other threads wrote
+            barrier.Wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int t = 1; t < nThreads; ++t) threads.emplace_back(worker, t);
+    worker(0);
+    for (auto &th : threads) th.join();
+
+    if (nPasses & 1) std::swap(*v, tempVector);
+}
+
 void std_sort_bench(picobench::state &s) {
   auto v = InitVector(s.iterations());
   {
-    picobench::scope scope(s);
+    bench::perf_scope scope(s);
     std::sort(v.begin(), v.end());
   }
   CheckSorted(v);
@@ -88,7 +280,7 @@ void std_sort_bench(picobench::state &s) {
 void std_stable_sort_bench(picobench::state &s) {
   auto v = InitVector(s.iterations());
   {
-    picobench::scope scope(s);
+    bench::perf_scope scope(s);
     std::stable_sort(v.begin(), v.end());
   }
   CheckSorted(v);
@@ -97,7 +289,7 @@ void std_stable_sort_bench(picobench::state &s) {
 void heap_sort_bench(picobench::state &s) {
   auto v = InitVector(s.iterations());
   {
-    picobench::scope scope(s);
+    bench::perf_scope scope(s);
     std::make_heap(v.begin(), v.end());
     std::sort_heap(v.begin(), v.end());
   }
@@ -107,12 +299,159 @@ void heap_sort_bench(picobench::state &s) {
 void radix_sort_bench(picobench::state &s) {
   auto v = InitVector(s.iterations());
   {
-    picobench::scope scope(s);
+    bench::perf_scope scope(s);
     RadixSort(&v);
   }
   CheckSorted(v);
 }
 
+void par_radix_sort_bench(picobench::state &s) {
+  auto v = InitVector(s.iterations());
+  bench::all_cores_scope cores;
+  {
+    bench::perf_scope scope(s);
+    ParallelRadixSort(&v);
+  }
+  CheckSorted(v);
+}
+
+void radix_auto_bench(picobench::state &s) {
+  auto v = InitVector(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v);
+  }
+  CheckSorted(v);
+}
+
+// plain 8-bit kernels, the reference for the two below
+void radix8_bench(picobench::state &s) {
+  auto v = InitVector(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v, 8);
+  }
+  CheckSorted(v);
+}
+
+// sub-histograms + write-combined scatter, scalar histogram
+void radix_wc_bench(picobench::state &s) {
+  auto v = InitVector(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortSIMD(&v, false);
+  }
+  CheckSorted(v);
+}
+
+// same with the AVX2 histogram when the cpu has it
+void radix_avx2_bench(picobench::state &s) {
+  auto v = InitVector(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortSIMD(&v);
+  }
+  CheckSorted(v);
+}
+
+void dist_std_sort_bench(picobench::state &s) {
+  auto v = InitDistribution(s.iterations(), s.user_data());
+  {
+    bench::perf_scope scope(s);
+    std::sort(v.begin(), v.end());
+  }
+  CheckSorted(v);
+}
+
+void dist_radix_sort_bench(picobench::state &s) {
+  auto v = InitDistribution(s.iterations(), s.user_data());
+  {
+    bench::perf_scope scope(s);
+    RadixSort(&v);
+  }
+  CheckSorted(v);
+}
+
+void dist_radix8_bench(picobench::state &s) {
+  auto v = InitDistribution(s.iterations(), s.user_data());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v, 8);
+  }
+  CheckSorted(v);
+}
+
+void dist_radix_auto_bench(picobench::state &s) {
+  auto v = InitDistribution(s.iterations(), s.user_data());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v);
+  }
+  CheckSorted(v);
+}
+
+void ts_std_sort_bench(picobench::state &s) {
+  auto v = InitTimestamps(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    std::sort(v.begin(), v.end());
+  }
+  CheckSorted(v);
+}
+
+void ts_radix8_bench(picobench::state &s) {
+  auto v = InitTimestamps(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v, 8);
+  }
+  CheckSorted(v);
+}
+
+void ts_radix_auto_bench(picobench::state &s) {
+  auto v = InitTimestamps(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v);
+  }
+  CheckSorted(v);
+}
+
+void std_sort_kv_bench(picobench::state &s) {
+  auto v = InitKeyValues(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    std::sort(v.begin(), v.end(), KeyLess);
+  }
+  CheckSorted(v, KeyLess);
+}
+
+void radix_sort_kv_bench(picobench::state &s) {
+  auto v = InitKeyValues(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortBy(&v, [](const KeyValue64 &kv) { return kv.key; });
+  }
+  CheckSorted(v, KeyLess);
+}
+
+void std_sort_float_bench(picobench::state &s) {
+  auto v = InitFloats(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    std::sort(v.begin(), v.end());
+  }
+  CheckSorted(v);
+}
+
+void radix_sort_float_bench(picobench::state &s) {
+  auto v = InitFloats(s.iterations());
+  {
+    bench::perf_scope scope(s);
+    RadixSortKeys(&v);
+  }
+  CheckSorted(v);
+}
 
 PICOBENCH(std_sort_bench)
     .iterations({64, 512, 4096, 32768, 262144, 2097152})
@@ -127,6 +466,89 @@ PICOBENCH(heap_sort_bench)
 PICOBENCH(radix_sort_bench)
     .iterations({64, 512, 4096, 32768, 262144, 2097152});
 
+PICOBENCH(par_radix_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
+PICOBENCH(radix_auto_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
+PICOBENCH(radix8_bench)
+    .iterations({262144, 2097152});
+
+PICOBENCH(radix_wc_bench)
+    .iterations({262144, 2097152});
+
+PICOBENCH(radix_avx2_bench)
+    .iterations({262144, 2097152});
+
+PICOBENCH_SUITE("presorted");
+
+PICOBENCH(dist_std_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kPresorted)
+    .baseline();
+
+PICOBENCH(dist_radix_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kPresorted);
+
+PICOBENCH(dist_radix8_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kPresorted);
+
+PICOBENCH(dist_radix_auto_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kPresorted);
+
+PICOBENCH_SUITE("low entropy");
+
+PICOBENCH(dist_std_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kLowEntropy)
+    .baseline();
+
+PICOBENCH(dist_radix_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kLowEntropy);
+
+PICOBENCH(dist_radix8_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kLowEntropy);
+
+PICOBENCH(dist_radix_auto_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .user_data(kLowEntropy);
+
+PICOBENCH_SUITE("narrow range uint64 timestamps");
+
+PICOBENCH(ts_std_sort_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .baseline();
+
+PICOBENCH(ts_radix8_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
+PICOBENCH(ts_radix_auto_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
+PICOBENCH_SUITE("uint64 key + uint32 payload");
+
+PICOBENCH(std_sort_kv_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .baseline();
+
+PICOBENCH(radix_sort_kv_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
+PICOBENCH_SUITE("float key");
+
+PICOBENCH(std_sort_float_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152})
+    .baseline();
+
+PICOBENCH(radix_sort_float_bench)
+    .iterations({64, 512, 4096, 32768, 262144, 2097152});
+
 
 /*
 
@@ -0,0 +1,140 @@
+#pragma once
+// Input generators for sort benchmarks: the shapes production data tends to
+// have, for plain uint32 keys and for 16/32/64-byte records with a uint64
+// key. All keys stay below 2^32 so the same key sequence can fill both.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+enum class SortDistribution : uintptr_t {
+    kUniform,      // independent uniform keys
+    kSorted,       // already ascending
+    kNearlySorted, // ascending, then 1% of elements swapped with a close neighbour
+    kReverse,      // descending
+    kReverseRuns,  // ascending overall, but made of descending runs of 1024
+    kDuplicates,   // only 16 distinct keys
+    kZipf,         // Zipf(s = 1) over 65536 distinct keys: few keys dominate
+    kCount
+};
+
+inline const char *SortDistributionName(SortDistribution d) {
+    switch (d) {
+    case SortDistribution::kUniform: return "uniform";
+    case SortDistribution::kSorted: return "sorted";
+    case SortDistribution::kNearlySorted: return "nearly sorted";
+    case SortDistribution::kReverse: return "reverse";
+    case SortDistribution::kReverseRuns: return "reverse runs";
+    case SortDistribution::kDuplicates: return "duplicates";
+    case SortDistribution::kZipf: return "zipf";
+    case SortDistribution::kCount: break;
+    }
+    return "unknown";
+}
+
+// splitmix64 finalizer, spreads Zipf ranks over the key space
+inline uint64_t SortDataMix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+inline std::vector<uint32_t> MakeSortKeys(SortDistribution dist, size_t n, uint32_t seed = 1234) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint32_t> uniform;
+    std::vector<uint32_t> keys(n);
+
+    switch (dist) {
+    case SortDistribution::kUniform:
+        for (auto &k : keys) k = uniform(gen);
+        break;
+    case SortDistribution::kSorted:
+    case SortDistribution::kNearlySorted:
+    case SortDistribution::kReverse:
+    case SortDistribution::kReverseRuns:
+        for (auto &k : keys) k = uniform(gen);
+        std::sort(keys.begin(), keys.end());
+        if (dist == SortDistribution::kNearlySorted && n > 1) {
+            std::uniform_int_distribution<size_t> pos(0, n - 1);
+            std::uniform_int_distribution<size_t> dist16(1, 16);
+            for (size_t i = 0; i < n / 100; ++i) {
+                size_t a = pos(gen);
+                size_t b = std::min(n - 1, a + dist16(gen));
+                std::swap(keys[a], keys[b]);
+            }
+        } else if (dist == SortDistribution::kReverse) {
+            std::reverse(keys.begin(), keys.end());
+        } else if (dist == SortDistribution::kReverseRuns) {
+            constexpr size_t runLength = 1024;
+            for (size_t i = 0; i < n; i += runLength)
+                std::reverse(keys.begin() + i, keys.begin() + std::min(n, i + runLength));
+        }
+        break;
+    case SortDistribution::kDuplicates: {
+        uint32_t values[16];
+        for (auto &v : values) v = uniform(gen);
+        std::uniform_int_distribution<int> pick(0, 15);
+        for (auto &k : keys) k = values[pick(gen)];
+        break;
+    }
+    case SortDistribution::kZipf: {
+        constexpr int nValues = 1 << 16;
+        // P(rank r) ~ 1 / r, inverted through the cumulative weights
+        static const std::vector<double> cdf = [] {
+            std::vector<double> c(nValues);
+            double sum = 0;
+            for (int r = 0; r < nValues; ++r) c[r] = sum += 1.0 / (r + 1);
+            for (auto &x : c) x /= sum;
+            return c;
+        }();
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        for (auto &k : keys) {
+            size_t rank = std::lower_bound(cdf.begin(), cdf.end(), u(gen)) - cdf.begin();
+            k = uint32_t(SortDataMix(rank));
+        }
+        break;
+    }
+    case SortDistribution::kCount:
+        break;
+    }
+    return keys;
+}
+
+// Record of Bytes bytes sorted by its leading key; the payload only exists
+// to make moves as expensive as they are with real structs
+template <size_t Bytes>
+struct SortRecord {
+    static_assert(Bytes > sizeof(uint64_t), "SortRecord needs room for a payload");
+    uint64_t key;
+    uint8_t payload[Bytes - sizeof(uint64_t)];
+};
+
+inline uint32_t SortKey(uint32_t v) { return v; }
+
+template <size_t Bytes>
+uint64_t SortKey(const SortRecord<Bytes> &r) { return r.key; }
+
+struct SortKeyLess {
+    template <typename T>
+    bool operator()(const T &a, const T &b) const { return SortKey(a) < SortKey(b); }
+};
+
+inline void MakeSortElement(uint32_t key, size_t, uint32_t *out) { *out = key; }
+
+template <size_t Bytes>
+void MakeSortElement(uint32_t key, size_t index, SortRecord<Bytes> *out) {
+    out->key = key;
+    for (size_t i = 0; i < sizeof(out->payload); ++i) out->payload[i] = uint8_t(index + i);
+}
+
+template <typename T>
+std::vector<T> MakeSortData(SortDistribution dist, size_t n, uint32_t seed = 1234) {
+    auto keys = MakeSortKeys(dist, n, seed);
+    std::vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) MakeSortElement(keys[i], i, &v[i]);
+    return v;
+}
@@ -0,0 +1,120 @@
+// Sort algorithms over distribution x element size, to pick an algorithm by
+// the shape of the data rather than by uniform random numbers.
+// One suite per (distribution, element size), std::sort is the baseline of
+// each; run a slice with e.g. --run-suite="nearly sorted / 32B".
+
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+#include "bench_affinity.hpp"
+#include "radix_sort.h"
+#include "sort_data.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#if defined(__cpp_lib_parallel_algorithm)
+#define SORT_MATRIX_HAS_EXECUTION 1
+#endif
+
+template <typename T>
+void StdSort(std::vector<T> &v) {
+    std::sort(v.begin(), v.end(), SortKeyLess());
+}
+
+template <typename T>
+void StdStableSort(std::vector<T> &v) {
+    std::stable_sort(v.begin(), v.end(), SortKeyLess());
+}
+
+template <typename T>
+void HeapSort(std::vector<T> &v) {
+    std::make_heap(v.begin(), v.end(), SortKeyLess());
+    std::sort_heap(v.begin(), v.end(), SortKeyLess());
+}
+
+template <typename T>
+void RadixSortAny(std::vector<T> &v) {
+    RadixSortBy(&v, [](const T &e) { return SortKey(e); });
+}
+
+#if defined(SORT_MATRIX_HAS_EXECUTION)
+template <typename T>
+void ParSort(std::vector<T> &v) {
+    std::sort(std::execution::par, v.begin(), v.end(), SortKeyLess());
+}
+
+template <typename T>
+void ParStableSort(std::vector<T> &v) {
+    std::stable_sort(std::execution::par, v.begin(), v.end(), SortKeyLess());
+}
+
+template <typename T>
+void ParUnseqSort(std::vector<T> &v) {
+    std::sort(std::execution::par_unseq, v.begin(), v.end(), SortKeyLess());
+}
+#endif
+
+template <typename T, void (*Sort)(std::vector<T> &)>
+void MatrixBench(picobench::state &s) {
+    auto v = MakeSortData<T>(SortDistribution(s.user_data()), size_t(s.iterations()));
+    {
+        bench::perf_scope scope(s);
+        Sort(v);
+    }
+    if (!std::is_sorted(v.begin(), v.end(), SortKeyLess())) {
+        std::cout << "Error: data is not sorted" << std::endl;
+    }
+}
+
+// The par variants need every core; all other cases stay pinned to the first one
+template <typename T, void (*Sort)(std::vector<T> &)>
+void ParallelMatrixBench(picobench::state &s) {
+    bench::all_cores_scope cores;
+    MatrixBench<T, Sort>(s);
+}
+
+// picobench keeps the suite name pointers
+static std::deque<std::string> &SuiteNames() {
+    static std::deque<std::string> names;
+    return names;
+}
+
+template <typename T>
+void RegisterElementType(const char *typeName) {
+    using picobench::global_registry;
+    const std::vector<int> dims = {4096, 65536, 1048576};
+    for (uintptr_t d = 0; d < uintptr_t(SortDistribution::kCount); ++d) {
+        SuiteNames().push_back(std::string(SortDistributionName(SortDistribution(d))) + " / " + typeName);
+        global_registry::set_bench_suite(SuiteNames().back().c_str());
+
+        global_registry::new_benchmark("std_sort", MatrixBench<T, StdSort<T>>)
+            .iterations(dims).user_data(d).baseline();
+        global_registry::new_benchmark("stable_sort", MatrixBench<T, StdStableSort<T>>)
+            .iterations(dims).user_data(d);
+        global_registry::new_benchmark("heap_sort", MatrixBench<T, HeapSort<T>>)
+            .iterations(dims).user_data(d);
+        global_registry::new_benchmark("radix_sort", MatrixBench<T, RadixSortAny<T>>)
+            .iterations(dims).user_data(d);
+#if defined(SORT_MATRIX_HAS_EXECUTION)
+        global_registry::new_benchmark("par_sort", ParallelMatrixBench<T, ParSort<T>>)
+            .iterations(dims).user_data(d);
+        global_registry::new_benchmark("par_stable_sort", ParallelMatrixBench<T, ParStableSort<T>>)
+            .iterations(dims).user_data(d);
+        global_registry::new_benchmark("par_unseq_sort", ParallelMatrixBench<T, ParUnseqSort<T>>)
+            .iterations(dims).user_data(d);
+#endif
+    }
+}
+
+static int registered = [] {
+    RegisterElementType<uint32_t>("4B");
+    RegisterElementType<SortRecord<16>>("16B");
+    RegisterElementType<SortRecord<32>>("32B");
+    RegisterElementType<SortRecord<64>>("64B");
+    return 0;
+}();
@@ -0,0 +1,225 @@
+#pragma once
+// Allocation statistics for finding hot spots before moving a container to a
+// pool: counts, bytes, bytes in use and their peak, a power-of-two size
+// histogram and, optionally, every Nth call stack. Two front ends share the
+// same alloc_stats:
+//  - tracking_resource wraps any std::pmr::memory_resource,
+//  - tracking_allocator<T, Alloc> wraps any STL allocator (std::allocator,
+//    limited_allocator, ...).
+// Counters are atomic, so one alloc_stats may be shared between threads.
+// Stack traces need glibc's backtrace(); link with -rdynamic to get
+// function names instead of bare addresses.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#define ALLOC_TRACKER_HAS_BACKTRACE 1
+#endif
+
+class alloc_stats {
+public:
+  // bucket i counts sizes in (2^(i-1), 2^i], the last one everything larger
+  static constexpr int kBuckets = 24;
+  static constexpr int kMaxFrames = 16;
+
+  // sample_every: record the call stack of every Nth allocation, 0 = never
+  explicit alloc_stats(size_t sample_every = 0) : sample_every_(sample_every) {}
+
+  void on_allocate(size_t bytes) {
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    histogram_[bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+    if (sample_every_ && sample_counter_.fetch_add(1, std::memory_order_relaxed) % sample_every_ == 0) {
+      sample_stack(bytes);
+    }
+  }
+
+  void on_deallocate(size_t bytes) {
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  size_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+  size_t deallocations() const { return deallocations_.load(std::memory_order_relaxed); }
+  size_t bytes_allocated() const { return bytes_allocated_.load(std::memory_order_relaxed); }
+  size_t bytes_in_use() const { return bytes_in_use_.load(std::memory_order_relaxed); }
+  size_t peak_bytes() const { return peak_bytes_.load(std::memory_order_relaxed); }
+  size_t histogram(int i) const { return histogram_[i].load(std::memory_order_relaxed); }
+
+  static int bucket(size_t bytes) {
+    int b = 0;
+    while (b < kBuckets - 1 && (size_t(1) << b) < bytes) ++b;
+    return b;
+  }
+
+  void reset() {
+    allocations_ = deallocations_ = 0;
+    bytes_allocated_ = bytes_in_use_ = peak_bytes_ = 0;
+    for (auto &h : histogram_) h = 0;
+    std::lock_guard<std::mutex> lock(stacks_mutex_);
+    stacks_.clear();
+  }
+
+  // top_stacks: how many of the most frequent sampled call stacks to print
+  void report(std::ostream &os, size_t top_stacks = 5) const {
+    os << "allocations:   " << allocations() << " (" << bytes_allocated() << " bytes)\n"
+       << "deallocations: " << deallocations() << "\n"
+       << "in use:        " << bytes_in_use() << " bytes\n"
+       << "peak:          " << peak_bytes() << " bytes\n"
+       << "size histogram:\n";
+    for (int i = 0; i < kBuckets; ++i) {
+      size_t n = histogram(i);
+      if (!n) continue;
+      os << "  " << (i + 1 < kBuckets ? "<= " : " > ") << (size_t(1) << (i + 1 < kBuckets ? i : i - 1)) << ": "
+         << n << "\n";
+    }
+    report_stacks(os, top_stacks);
+  }
+
+private:
+  struct stack_sample {
+    size_t count = 0;
+    size_t bytes = 0;
+  };
+
+  void sample_stack(size_t bytes) {
+#if defined(ALLOC_TRACKER_HAS_BACKTRACE)
+    void *frames[kMaxFrames];
+    int n = backtrace(frames, kMaxFrames);
+    std::vector<void *> key(frames, frames + n);
+    std::lock_guard<std::mutex> lock(stacks_mutex_);
+    auto &s = stacks_[key];
+    ++s.count;
+    s.bytes += bytes;
+#else
+    (void)bytes;
+#endif
+  }
+
+  void report_stacks(std::ostream &os, size_t top) const {
+    std::lock_guard<std::mutex> lock(stacks_mutex_);
+    if (!sample_every_ || stacks_.empty()) return;
+    std::vector<const std::pair<const std::vector<void *>, stack_sample> *> order;
+    for (auto &s : stacks_) order.push_back(&s);
+    std::sort(order.begin(), order.end(),
+              [](auto a, auto b) { return a->second.count > b->second.count; });
+    order.resize(std::min(top, order.size()));
+    os << "sampled call stacks (1 in " << sample_every_ << " allocations):\n";
+    for (auto s : order) {
+      os << "  " << s->second.count << " samples, " << s->second.bytes << " bytes\n";
+#if defined(ALLOC_TRACKER_HAS_BACKTRACE)
+      auto &frames = s->first;
+      char **names = backtrace_symbols(frames.data(), int(frames.size()));
+      for (size_t i = 0; i < frames.size(); ++i) {
+        os << "    " << (names ? names[i] : "?") << "\n";
+      }
+      free(names);
+#endif
+    }
+  }
+
+  const size_t sample_every_;
+  std::atomic<size_t> allocations_{0};
+  std::atomic<size_t> deallocations_{0};
+  std::atomic<size_t> bytes_allocated_{0};
+  std::atomic<size_t> bytes_in_use_{0};
+  std::atomic<size_t> peak_bytes_{0};
+  std::array<std::atomic<size_t>, kBuckets> histogram_{};
+  std::atomic<size_t> sample_counter_{0};
+
+  mutable std::mutex stacks_mutex_;
+  std::map<std::vector<void *>, stack_sample> stacks_;
+};
+
+class tracking_resource : public std::pmr::memory_resource {
+public:
+  explicit tracking_resource(alloc_stats *stats,
+                             std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : stats_(stats), upstream_(upstream) {}
+
+  alloc_stats *stats() const noexcept { return stats_; }
+  std::pmr::memory_resource *upstream_resource() const noexcept { return upstream_; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    void *p = upstream_->allocate(bytes, alignment);
+    stats_->on_allocate(bytes);
+    return p;
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    stats_->on_deallocate(bytes);
+    upstream_->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    auto o = dynamic_cast<const tracking_resource *>(&other);
+    return this == &other || (o && o->stats_ == stats_ && upstream_->is_equal(*o->upstream_));
+  }
+
+private:
+  alloc_stats *stats_;
+  std::pmr::memory_resource *upstream_;
+};
+
+// Forwards to Alloc and records into stats; rebinding keeps the stats, so a
+// node container reports its node allocations
+template <class T, class Alloc = std::allocator<T>> struct tracking_allocator {
+  using traits = std::allocator_traits<Alloc>;
+  using value_type = T;
+  using size_type = typename traits::size_type;
+  using difference_type = typename traits::difference_type;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  template <class Other> struct rebind {
+    typedef tracking_allocator<Other, typename traits::template rebind_alloc<Other>> other;
+  };
+
+  explicit tracking_allocator(alloc_stats *stats, const Alloc &alloc = Alloc()) : stats(stats), alloc(alloc) {}
+  template <class Other, class OtherAlloc>
+  tracking_allocator(const tracking_allocator<Other, OtherAlloc> &other) noexcept
+      : stats(other.stats), alloc(other.alloc) {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    T *p = traits::allocate(alloc, n);
+    stats->on_allocate(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(T *p, size_t n) noexcept {
+    stats->on_deallocate(n * sizeof(T));
+    traits::deallocate(alloc, p, n);
+  }
+
+  size_type max_size() const noexcept { return traits::max_size(alloc); }
+
+  template <class Other, class OtherAlloc>
+  bool operator==(const tracking_allocator<Other, OtherAlloc> &other) const noexcept {
+    return stats == other.stats && alloc == other.alloc;
+  }
+  template <class Other, class OtherAlloc>
+  bool operator!=(const tracking_allocator<Other, OtherAlloc> &other) const noexcept {
+    return !(*this == other);
+  }
+
+  alloc_stats *stats;
+  Alloc alloc;
+};
@@ -0,0 +1,182 @@
+#pragma once
+// Linear arena for per-frame / per-request scratch memory: allocation is an
+// aligned pointer bump, freeing is rewinding to a marker. Unlike
+// std::pmr::monotonic_buffer_resource it can go back to any earlier point
+// (arena_scope does so on scope exit) and keeps its chunks for reuse, so a
+// steady state loop never calls upstream.
+//
+// Chunks are chained from upstream as needed, each one growth_factor times
+// the previous (up to max_chunk_size); a request larger than that gets a
+// chunk of its own. An initial buffer, e.g. on the stack, can be given as
+// the first chunk. deallocate() only reclaims the most recent allocation;
+// everything else is freed by rewind(), reset() or release().
+//
+// Not thread-safe.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+struct arena_options {
+  size_t initial_chunk_size = 64 * 1024;
+  size_t max_chunk_size = 16 * 1024 * 1024;
+  size_t growth_factor = 2;
+};
+
+class arena_resource : public std::pmr::memory_resource {
+  struct chunk {
+    chunk *next;
+    size_t size; // including this header
+    bool owned;  // false for the initial buffer
+
+    std::byte *begin() { return reinterpret_cast<std::byte *>(this + 1); }
+    std::byte *end() { return reinterpret_cast<std::byte *>(this) + size; }
+  };
+
+public:
+  // position to rewind to
+  struct marker {
+    chunk *c;
+    std::byte *ptr;
+  };
+
+  explicit arena_resource(arena_options options = {},
+                          std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : options_(options), upstream_(upstream), next_chunk_size_(options.initial_chunk_size) {}
+
+  // uses buffer as the first chunk, then grows from upstream
+  arena_resource(void *buffer, size_t size, arena_options options = {},
+                 std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : arena_resource(options, upstream) {
+    void *p = buffer;
+    if (std::align(alignof(chunk), sizeof(chunk), p, size)) {
+      first_ = current_ = ::new (p) chunk{nullptr, size, false};
+      ptr_ = current_->begin();
+    }
+  }
+
+  arena_resource(const arena_resource &) = delete;
+  arena_resource &operator=(const arena_resource &) = delete;
+  ~arena_resource() override { release(); }
+
+  marker mark() const noexcept { return {current_, ptr_}; }
+
+  // frees everything allocated after m was taken; the chunks stay
+  void rewind(marker m) noexcept {
+    current_ = m.c;
+    ptr_ = m.ptr;
+    if (!current_) {
+      current_ = first_;
+      ptr_ = first_ ? first_->begin() : nullptr;
+    }
+  }
+
+  void reset() noexcept { rewind({first_, first_ ? first_->begin() : nullptr}); }
+
+  // returns all chunks but the initial buffer to upstream
+  void release() noexcept {
+    chunk *keep = nullptr;
+    for (chunk *c = first_; c;) {
+      chunk *next = c->next;
+      if (c->owned) {
+        upstream_->deallocate(c, c->size, alignof(std::max_align_t));
+      } else {
+        keep = c;
+        keep->next = nullptr;
+      }
+      c = next;
+    }
+    first_ = current_ = keep;
+    ptr_ = keep ? keep->begin() : nullptr;
+    next_chunk_size_ = options_.initial_chunk_size;
+  }
+
+  // n value-initialized Ts; the arena never runs destructors
+  template <class T> T *make_array(size_t n) {
+    static_assert(std::is_trivially_destructible_v<T>, "arena memory is reclaimed without running destructors");
+    if (n > SIZE_MAX / sizeof(T)) throw std::bad_array_new_length();
+    T *p = static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    for (size_t i = 0; i < n; ++i) ::new (p + i) T();
+    return p;
+  }
+
+  // bytes in chunks obtained from upstream or the initial buffer
+  size_t capacity() const noexcept {
+    size_t total = 0;
+    for (chunk *c = first_; c; c = c->next) total += c->size - sizeof(chunk);
+    return total;
+  }
+
+  std::pmr::memory_resource *upstream_resource() const noexcept { return upstream_; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    if (void *p = bump(bytes, alignment)) return p;
+    return allocate_slow(bytes, alignment);
+  }
+
+  // only the last allocation can be given back
+  void do_deallocate(void *p, size_t bytes, size_t) override {
+    if (current_ && static_cast<std::byte *>(p) + bytes == ptr_) ptr_ = static_cast<std::byte *>(p);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+  void *bump(size_t bytes, size_t alignment) noexcept {
+    if (!current_) return nullptr;
+    auto addr = reinterpret_cast<uintptr_t>(ptr_);
+    uintptr_t aligned = (addr + alignment - 1) & ~uintptr_t(alignment - 1);
+    auto end = reinterpret_cast<uintptr_t>(current_->end());
+    if (aligned > end || end - aligned < bytes) return nullptr;
+    ptr_ = reinterpret_cast<std::byte *>(aligned + bytes);
+    return reinterpret_cast<void *>(aligned);
+  }
+
+  // moves to the next retained chunk that fits, or chains a new one
+  void *allocate_slow(size_t bytes, size_t alignment) {
+    for (chunk *c = current_ ? current_->next : nullptr; c; c = c->next) {
+      current_ = c;
+      ptr_ = c->begin();
+      if (void *p = bump(bytes, alignment)) return p;
+    }
+    size_t needed = sizeof(chunk) + bytes + alignment;
+    size_t size = std::max(next_chunk_size_, needed);
+    void *mem = upstream_->allocate(size, alignof(std::max_align_t));
+    chunk *c = ::new (mem) chunk{nullptr, size, true};
+    if (current_) {
+      current_->next = c;
+    } else {
+      first_ = c;
+    }
+    current_ = c;
+    ptr_ = c->begin();
+    next_chunk_size_ = std::min(options_.max_chunk_size, next_chunk_size_ * options_.growth_factor);
+    return bump(bytes, alignment);
+  }
+
+  const arena_options options_;
+  std::pmr::memory_resource *upstream_;
+  size_t next_chunk_size_;
+  chunk *first_ = nullptr;
+  chunk *current_ = nullptr;
+  std::byte *ptr_ = nullptr;
+};
+
+// rewinds the arena to where it was on construction
+class arena_scope {
+public:
+  explicit arena_scope(arena_resource &arena) : arena_(arena), marker_(arena.mark()) {}
+  ~arena_scope() { arena_.rewind(marker_); }
+
+  arena_scope(const arena_scope &) = delete;
+  arena_scope &operator=(const arena_scope &) = delete;
+
+private:
+  arena_resource &arena_;
+  arena_resource::marker marker_;
+};
@@ -0,0 +1,78 @@
+// Per-request scratch memory: each iteration handles one "request" that
+// builds a few temporary containers (a vector grown element by element, a
+// list, strings) and drops them at the end. Compares new/delete (the
+// baseline), a monotonic_buffer_resource created per request and one
+// arena_resource rewound by an arena_scope after every request.
+
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+#include "ArenaAllocator.h"
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+static uint64_t HandleRequest(std::pmr::memory_resource *r, uint32_t seed) {
+  std::pmr::vector<uint32_t> values(r);
+  size_t n = 64 + seed % 1024;
+  for (size_t i = 0; i < n; ++i) values.push_back(uint32_t(i * seed));
+
+  std::pmr::list<uint32_t> pending(r);
+  for (size_t i = 0; i < 32; ++i) pending.push_back(values[i]);
+
+  std::pmr::vector<std::pmr::string> names(r);
+  names.reserve(8);
+  for (size_t i = 0; i < 8; ++i) names.emplace_back(40 + i, char('a' + i));
+
+  uint64_t sum = 0;
+  for (auto v : values) sum += v;
+  for (auto v : pending) sum ^= v;
+  return sum + names.back().size();
+}
+
+void request_new_delete(picobench::state &s) {
+  uint64_t sum = 0;
+  bench::perf_scope scope(s);
+  for (auto i : s) sum += HandleRequest(std::pmr::new_delete_resource(), uint32_t(i));
+  s.set_result(sum);
+}
+
+void request_monotonic(picobench::state &s) {
+  uint64_t sum = 0;
+  bench::perf_scope scope(s);
+  for (auto i : s) {
+    std::pmr::monotonic_buffer_resource resource;
+    sum += HandleRequest(&resource, uint32_t(i));
+  }
+  s.set_result(sum);
+}
+
+void request_monotonic_buf(picobench::state &s) {
+  static std::array<std::byte, 64 * 1024> buffer;
+  uint64_t sum = 0;
+  bench::perf_scope scope(s);
+  for (auto i : s) {
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+    sum += HandleRequest(&resource, uint32_t(i));
+  }
+  s.set_result(sum);
+}
+
+void request_arena(picobench::state &s) {
+  arena_resource arena;
+  uint64_t sum = 0;
+  bench::perf_scope scope(s);
+  for (auto i : s) {
+    arena_scope frame(arena);
+    sum += HandleRequest(&arena, uint32_t(i));
+  }
+  s.set_result(sum);
+}
+
+PICOBENCH(request_new_delete).iterations({1024, 16384}).baseline();
+PICOBENCH(request_monotonic).iterations({1024, 16384});
+PICOBENCH(request_monotonic_buf).iterations({1024, 16384});
+PICOBENCH(request_arena).iterations({1024, 16384});
@@ -4,6 +4,11 @@
 #include <vector>
 #include <memory_resource>
 #include <array>
+#include <list>
+
+#include "AllocTracker.h"
+#include "ArenaAllocator.h"
+#include "PoolAllocator.h"
 
 // extented version
 // inspired by https://stackoverflow.com/a/72771645
@@ -114,4 +119,66 @@ int main() {
     std::vector<int, limited_pmr_allocator<int, 10>> vec{al};
     CheckVec(vec, al);
   }
+
+  // fixed-capacity pool: nodes are recycled, the 11th live node throws
+  {
+    std::list<int, pool_allocator<int, 10>> list;
+    try {
+      for (int i = 0; i < 50; i++) {
+        list.push_back(i);
+        if (list.size() > 5) list.pop_front();
+      }
+      for (int i = 0; i < 50; i++) {
+        list.push_back(i);
+      }
+    } catch (const std::bad_alloc &ex) {
+      std::cout << "bad_alloc: " << ex.what() << '\n';
+    }
+    std::cout << list.size() << std::endl;
+  }
+
+  {
+    fixed_pool_resource resource(32, 10);
+    std::pmr::list<int> list(&resource);
+    for (int i = 0; i < 10; i++) {
+      list.push_back(i);
+    }
+    std::cout << list.size() << " " << resource.pool().free_count() << std::endl;
+  }
+
+  // where does a container allocate, and how much
+  {
+    alloc_stats stats(1);
+    tracking_resource resource(&stats);
+    std::pmr::list<int> list(&resource);
+    std::pmr::vector<int> vec(&resource);
+    for (int i = 0; i < 100; i++) {
+      list.push_back(i);
+      vec.push_back(i);
+    }
+    stats.report(std::cout, 2);
+  }
+
+  {
+    alloc_stats stats;
+    auto al = tracking_allocator<int, limited_allocator<int, 10>>(&stats);
+    std::vector<int, tracking_allocator<int, limited_allocator<int, 10>>> vec{al};
+    CheckVec(vec, al);
+    stats.report(std::cout);
+  }
+
+  // scratch memory per frame: a pointer bump, freed by rewinding
+  {
+    std::array<char, 1024> buffer{};
+    arena_resource arena(buffer.data(), buffer.size());
+    for (int frame = 0; frame < 3; frame++) {
+      arena_scope scope(arena);
+      float *weights = arena.make_array<float>(100);
+      std::pmr::vector<int> vec(&arena);
+      for (int i = 0; i < 1000; i++) {
+        vec.push_back(i);
+      }
+      std::cout << weights[0] << " " << vec.size() << " " << arena.capacity() << std::endl;
+    }
+  }
 }
\ No newline at end of file
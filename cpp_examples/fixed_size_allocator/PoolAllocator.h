@@ -0,0 +1,166 @@
+#pragma once
+// Fixed-capacity pool: one slab of N equally sized blocks, free blocks are
+// linked through their own first bytes (intrusive free list), so allocate and
+// deallocate are a pointer pop/push and freed nodes are reused right away.
+// Unlike limited_allocator, which only caps max_size() and still calls malloc
+// for every node, node containers (std::list, std::map, ...) stop touching
+// the heap once the slab exists.
+//
+// Not thread-safe, same as std::pmr::unsynchronized_pool_resource.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+class fixed_block_pool {
+public:
+  // slab memory comes from upstream and is returned in the destructor
+  fixed_block_pool(size_t block_size, size_t block_count, size_t block_align = alignof(std::max_align_t),
+                   std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : block_align_(std::max(block_align, alignof(free_block))),
+        // every block must hold the free list link and keep the next one aligned
+        block_size_(round_up(std::max(block_size, sizeof(free_block)), block_align_)),
+        block_count_(block_count), upstream_(upstream) {
+    slab_ = static_cast<std::byte *>(upstream_->allocate(block_size_ * block_count_, block_align_));
+    // link blocks in address order so a fresh pool hands them out sequentially
+    for (size_t i = block_count_; i-- > 0;) {
+      push(slab_ + i * block_size_);
+    }
+  }
+
+  fixed_block_pool(const fixed_block_pool &) = delete;
+  fixed_block_pool &operator=(const fixed_block_pool &) = delete;
+
+  ~fixed_block_pool() {
+    assert(free_count_ == block_count_ && "blocks still in use");
+    upstream_->deallocate(slab_, block_size_ * block_count_, block_align_);
+  }
+
+  // throws std::bad_alloc once all blocks are in use
+  void *allocate() {
+    if (!head_) throw std::bad_alloc();
+    free_block *b = head_;
+    head_ = b->next;
+    --free_count_;
+    return b;
+  }
+
+  void deallocate(void *p) noexcept {
+    assert(owns(p));
+    push(p);
+  }
+
+  bool owns(const void *p) const noexcept {
+    auto b = static_cast<const std::byte *>(p);
+    return b >= slab_ && b < slab_ + block_size_ * block_count_;
+  }
+
+  size_t block_size() const noexcept { return block_size_; }
+  size_t block_align() const noexcept { return block_align_; }
+  size_t capacity() const noexcept { return block_count_; }
+  size_t free_count() const noexcept { return free_count_; }
+
+private:
+  struct free_block {
+    free_block *next;
+  };
+
+  static size_t round_up(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+  void push(void *p) noexcept {
+    auto b = ::new (p) free_block{head_};
+    head_ = b;
+    ++free_count_;
+  }
+
+  const size_t block_align_;
+  const size_t block_size_;
+  const size_t block_count_;
+  std::pmr::memory_resource *upstream_;
+  std::byte *slab_ = nullptr;
+  free_block *head_ = nullptr;
+  size_t free_count_ = 0;
+};
+
+// STL allocator over a per-(T, N) pool of N blocks of sizeof(T).
+// Containers rebind to their node type, so std::list<int, pool_allocator<int, N>>
+// gets a pool of N list nodes. Stateless like limited_allocator: every
+// instance for the same (T, N) shares the pool. Single objects come from the
+// pool; arrays (n > 1) go to std::allocator.
+template <class T, size_t N> struct pool_allocator {
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template <class Other> struct rebind {
+    typedef pool_allocator<Other, N> other;
+  };
+
+  pool_allocator() = default;
+  template <class Other> constexpr pool_allocator(const pool_allocator<Other, N> &) noexcept {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    if (n == 1) {
+      return static_cast<T *>(pool().allocate());
+    }
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T *p, size_t n) noexcept {
+    if (n == 1) {
+      pool().deallocate(p);
+    } else {
+      std::allocator<T>().deallocate(p, n);
+    }
+  }
+
+  static fixed_block_pool &pool() {
+    static fixed_block_pool p(sizeof(T), N, alignof(T));
+    return p;
+  }
+
+  template <class Other> bool operator==(const pool_allocator<Other, N> &) const noexcept { return true; }
+  template <class Other> bool operator!=(const pool_allocator<Other, N> &) const noexcept { return false; }
+};
+
+// The same pool as a std::pmr::memory_resource. Requests up to block_size
+// (with at most block_align alignment) come from the slab, bigger ones such
+// as a hash table's bucket array go to upstream. Running out of blocks
+// throws std::bad_alloc: the capacity is fixed.
+class fixed_pool_resource : public std::pmr::memory_resource {
+public:
+  fixed_pool_resource(size_t block_size, size_t block_count,
+                      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : pool_(block_size, block_count, alignof(std::max_align_t), upstream), upstream_(upstream) {}
+
+  const fixed_block_pool &pool() const noexcept { return pool_; }
+  std::pmr::memory_resource *upstream_resource() const noexcept { return upstream_; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    if (bytes <= pool_.block_size() && alignment <= pool_.block_align()) {
+      return pool_.allocate();
+    }
+    return upstream_->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    if (pool_.owns(p)) {
+      pool_.deallocate(p);
+    } else {
+      upstream_->deallocate(p, bytes, alignment);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+  fixed_block_pool pool_;
+  std::pmr::memory_resource *upstream_;
+};
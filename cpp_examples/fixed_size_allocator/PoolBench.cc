@@ -0,0 +1,136 @@
+// Node container churn: a container keeps kLive elements while every
+// iteration erases one and inserts another, the pattern of a cache, an LRU
+// list or an order book. Compares the pool against std::allocator and
+// std::pmr::unsynchronized_pool_resource; std::allocator is the baseline.
+// Uses the picobench runner of ../benchmark, e.g. --samples=5 --json=out.json
+
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+#include "PoolAllocator.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <vector>
+
+constexpr int kLive = 4096;
+// room for the live nodes of one container
+constexpr size_t kPoolCapacity = kLive + 16;
+// larger than a std::map<uint64_t, uint64_t> node (48 bytes with libstdc++)
+constexpr size_t kBlockSize = 64;
+
+// splitmix64, distinct keys in random order
+static uint64_t MixKey(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// FIFO: pop the oldest node, push a new one
+template <class List> void ListChurn(picobench::state &s, List &list) {
+  for (int i = 0; i < kLive; ++i) list.push_back(i);
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s) {
+      list.pop_front();
+      list.push_back(i);
+    }
+  }
+  s.set_result(list.back());
+}
+
+// random keys: erase the key inserted kLive iterations ago, insert a new one
+template <class Map> void MapChurn(picobench::state &s, Map &map) {
+  std::vector<uint64_t> keys(size_t(s.iterations()) + kLive);
+  for (size_t i = 0; i < keys.size(); ++i) keys[i] = MixKey(i);
+  for (int i = 0; i < kLive; ++i) map.emplace(keys[i], i);
+  {
+    bench::perf_scope scope(s);
+    for (auto i : s) {
+      map.erase(keys[i]);
+      map.emplace(keys[i + kLive], i);
+    }
+  }
+  s.set_result(map.size());
+}
+
+void list_std_allocator(picobench::state &s) {
+  std::list<int> list;
+  ListChurn(s, list);
+}
+
+void list_pool_allocator(picobench::state &s) {
+  std::list<int, pool_allocator<int, kPoolCapacity>> list;
+  ListChurn(s, list);
+}
+
+void list_unsync_pool(picobench::state &s) {
+  std::pmr::unsynchronized_pool_resource resource;
+  std::pmr::list<int> list(&resource);
+  ListChurn(s, list);
+}
+
+void list_fixed_pool(picobench::state &s) {
+  fixed_pool_resource resource(kBlockSize, kPoolCapacity);
+  std::pmr::list<int> list(&resource);
+  ListChurn(s, list);
+}
+
+using MapStd = std::map<uint64_t, uint64_t>;
+using MapPool = std::map<uint64_t, uint64_t, std::less<uint64_t>,
+                         pool_allocator<std::pair<const uint64_t, uint64_t>, kPoolCapacity>>;
+using MapPmr = std::pmr::map<uint64_t, uint64_t>;
+
+void map_std_allocator(picobench::state &s) {
+  MapStd map;
+  MapChurn(s, map);
+}
+
+void map_pool_allocator(picobench::state &s) {
+  MapPool map;
+  MapChurn(s, map);
+}
+
+void map_unsync_pool(picobench::state &s) {
+  std::pmr::unsynchronized_pool_resource resource;
+  MapPmr map(&resource);
+  MapChurn(s, map);
+}
+
+void map_fixed_pool(picobench::state &s) {
+  fixed_pool_resource resource(kBlockSize, kPoolCapacity);
+  MapPmr map(&resource);
+  MapChurn(s, map);
+}
+
+PICOBENCH_SUITE("std::list churn");
+
+PICOBENCH(list_std_allocator)
+    .iterations({4096, 65536, 1048576})
+    .baseline();
+
+PICOBENCH(list_pool_allocator)
+    .iterations({4096, 65536, 1048576});
+
+PICOBENCH(list_unsync_pool)
+    .iterations({4096, 65536, 1048576});
+
+PICOBENCH(list_fixed_pool)
+    .iterations({4096, 65536, 1048576});
+
+PICOBENCH_SUITE("std::map churn");
+
+PICOBENCH(map_std_allocator)
+    .iterations({4096, 65536, 1048576})
+    .baseline();
+
+PICOBENCH(map_pool_allocator)
+    .iterations({4096, 65536, 1048576});
+
+PICOBENCH(map_unsync_pool)
+    .iterations({4096, 65536, 1048576});
+
+PICOBENCH(map_fixed_pool)
+    .iterations({4096, 65536, 1048576});
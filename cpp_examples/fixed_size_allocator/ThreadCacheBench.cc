@@ -0,0 +1,165 @@
+// Multi-threaded small object allocation: producer threads allocate 16-256
+// byte objects and hand them to consumer threads through a ring buffer, the
+// consumers free them, so every block is freed on another thread than the
+// one that allocated it. The "local churn" suites allocate and free on the
+// same thread. Compares thread_caching_resource against
+// std::pmr::synchronized_pool_resource and new/delete (malloc), which is the
+// baseline.
+
+// the threads need every core, not just the first one
+#define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+#include "ThreadCachePool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+constexpr size_t kSizeCount = 1024;
+
+// object sizes cycled through by every thread
+static const std::vector<size_t> &ObjectSizes() {
+  static const std::vector<size_t> sizes = [] {
+    std::vector<size_t> v(kSizeCount);
+    uint32_t x = 12345;
+    for (auto &s : v) {
+      x = x * 1664525u + 1013904223u;
+      s = 16 + (x >> 8) % 241;
+    }
+    return v;
+  }();
+  return sizes;
+}
+
+struct Block {
+  void *p;
+  size_t bytes;
+};
+
+// single producer, single consumer
+class BlockRing {
+public:
+  void push(Block b) {
+    size_t t = tail_.load(std::memory_order_relaxed);
+    while (t - head_.load(std::memory_order_acquire) == kCapacity) std::this_thread::yield();
+    items_[t % kCapacity] = b;
+    tail_.store(t + 1, std::memory_order_release);
+  }
+
+  Block pop() {
+    size_t h = head_.load(std::memory_order_relaxed);
+    while (tail_.load(std::memory_order_acquire) == h) std::this_thread::yield();
+    Block b = items_[h % kCapacity];
+    head_.store(h + 1, std::memory_order_release);
+    return b;
+  }
+
+private:
+  static constexpr size_t kCapacity = 1024;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  Block items_[kCapacity];
+};
+
+static void Produce(std::pmr::memory_resource *r, BlockRing *ring, size_t count) {
+  const auto &sizes = ObjectSizes();
+  for (size_t i = 0; i < count; ++i) {
+    size_t bytes = sizes[i % kSizeCount];
+    auto p = static_cast<char *>(r->allocate(bytes, alignof(std::max_align_t) / 2));
+    p[0] = char(i);
+    ring->push({p, bytes});
+  }
+}
+
+static void Consume(std::pmr::memory_resource *r, BlockRing *ring, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    Block b = ring->pop();
+    r->deallocate(b.p, b.bytes, alignof(std::max_align_t) / 2);
+  }
+}
+
+// each thread keeps up to 64 objects alive and replaces them round robin
+static void Churn(std::pmr::memory_resource *r, size_t count) {
+  const auto &sizes = ObjectSizes();
+  Block live[64] = {};
+  for (size_t i = 0; i < count; ++i) {
+    Block &slot = live[i % 64];
+    if (slot.p) r->deallocate(slot.p, slot.bytes, alignof(std::max_align_t) / 2);
+    slot.bytes = sizes[i % kSizeCount];
+    slot.p = r->allocate(slot.bytes, alignof(std::max_align_t) / 2);
+  }
+  for (auto &slot : live) {
+    if (slot.p) r->deallocate(slot.p, slot.bytes, alignof(std::max_align_t) / 2);
+  }
+}
+
+// user_data is the number of producer/consumer pairs
+static void ProducerConsumer(picobench::state &s, std::pmr::memory_resource *r) {
+  const size_t pairs = size_t(s.user_data());
+  const size_t perPair = size_t(s.iterations()) / pairs;
+  std::vector<BlockRing> rings(pairs);
+  {
+    bench::perf_scope scope(s);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < pairs; ++t) {
+      threads.emplace_back(Produce, r, &rings[t], perPair);
+      threads.emplace_back(Consume, r, &rings[t], perPair);
+    }
+    for (auto &th : threads) th.join();
+  }
+}
+
+// user_data is the number of threads
+static void LocalChurn(picobench::state &s, std::pmr::memory_resource *r) {
+  const size_t nThreads = size_t(s.user_data());
+  const size_t perThread = size_t(s.iterations()) / nThreads;
+  bench::perf_scope scope(s);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nThreads; ++t) threads.emplace_back(Churn, r, perThread);
+  for (auto &th : threads) th.join();
+}
+
+void pc_malloc(picobench::state &s) { ProducerConsumer(s, std::pmr::new_delete_resource()); }
+
+void pc_sync_pool(picobench::state &s) {
+  std::pmr::synchronized_pool_resource resource;
+  ProducerConsumer(s, &resource);
+}
+
+void pc_thread_caching(picobench::state &s) {
+  thread_caching_resource resource;
+  ProducerConsumer(s, &resource);
+}
+
+void churn_malloc(picobench::state &s) { LocalChurn(s, std::pmr::new_delete_resource()); }
+
+void churn_sync_pool(picobench::state &s) {
+  std::pmr::synchronized_pool_resource resource;
+  LocalChurn(s, &resource);
+}
+
+void churn_thread_caching(picobench::state &s) {
+  thread_caching_resource resource;
+  LocalChurn(s, &resource);
+}
+
+PICOBENCH_SUITE("producer/consumer, 1 pair");
+
+PICOBENCH(pc_malloc).iterations({65536, 1048576}).user_data(1).baseline();
+PICOBENCH(pc_sync_pool).iterations({65536, 1048576}).user_data(1);
+PICOBENCH(pc_thread_caching).iterations({65536, 1048576}).user_data(1);
+
+PICOBENCH_SUITE("producer/consumer, 4 pairs");
+
+PICOBENCH(pc_malloc).iterations({65536, 1048576}).user_data(4).baseline();
+PICOBENCH(pc_sync_pool).iterations({65536, 1048576}).user_data(4);
+PICOBENCH(pc_thread_caching).iterations({65536, 1048576}).user_data(4);
+
+PICOBENCH_SUITE("local churn, 4 threads");
+
+PICOBENCH(churn_malloc).iterations({65536, 1048576}).user_data(4).baseline();
+PICOBENCH(churn_sync_pool).iterations({65536, 1048576}).user_data(4);
+PICOBENCH(churn_thread_caching).iterations({65536, 1048576}).user_data(4);
@@ -0,0 +1,312 @@
+#pragma once
+// Thread-caching pool resource for small objects allocated and freed at high
+// rates from many threads. Requests are rounded up to a power-of-two size
+// class (8 to 1024 bytes); each thread keeps a free list per class and only
+// talks to the shared central pool in batches:
+//  - an empty thread list refills with one batch from the central pool,
+//    which carves new chunks from upstream when it has none;
+//  - a thread list grown past two batches hands one batch back.
+// Blocks are not owned by a thread, so memory may be freed on any thread:
+// it lands in the freeing thread's cache, and a consumer thread that frees
+// what a producer allocated keeps returning batches for the producer to
+// refill from. A thread's caches are flushed to the central pool when it
+// exits; all chunks go back to upstream when the resource is destroyed.
+//
+// Larger requests are passed through to upstream. Upstream calls are
+// serialized, so any upstream resource works.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+class thread_caching_resource;
+
+namespace thread_cache_detail {
+
+constexpr int kClassCount = 8; // 8, 16, ..., 1024 bytes
+constexpr size_t kMinBlock = 8;
+constexpr size_t kMaxBlock = kMinBlock << (kClassCount - 1);
+// chunks are page aligned, so every block is aligned to its own size
+constexpr size_t kChunkSize = 64 * 1024;
+constexpr size_t kChunkAlign = 4096;
+
+struct free_block {
+  free_block *next;
+};
+
+struct block_list {
+  free_block *head = nullptr;
+  size_t count = 0;
+};
+
+inline size_t block_size(int c) { return kMinBlock << c; }
+
+// blocks moved between a thread and the central pool at once
+inline size_t batch_size(int c) { return std::clamp<size_t>(8192 / block_size(c), 8, 64); }
+
+// -1 if the request is not served from a size class
+inline int size_class(size_t bytes, size_t alignment) {
+  size_t n = std::max({bytes, alignment, kMinBlock});
+  if (n > kMaxBlock) return -1;
+  int c = 0;
+  while (block_size(c) < n) ++c;
+  return c;
+}
+
+struct thread_cache {
+  block_list lists[kClassCount];
+};
+
+// per-thread lookup of the cache a thread uses for each resource, flushed
+// back to the resources that are still alive when the thread exits
+struct thread_caches {
+  struct entry {
+    uint64_t id;
+    thread_cache *cache;
+  };
+  uint64_t last_id = 0;
+  thread_cache *last = nullptr;
+  std::vector<entry> entries;
+
+  ~thread_caches();
+};
+
+inline thread_caches &local_caches() {
+  thread_local thread_caches caches;
+  return caches;
+}
+
+// live resources by id; ids are never reused, so a thread can tell a
+// destroyed resource from a new one at the same address
+inline std::mutex &registry_mutex() {
+  static std::mutex m;
+  return m;
+}
+
+inline std::unordered_map<uint64_t, thread_caching_resource *> &registry() {
+  static std::unordered_map<uint64_t, thread_caching_resource *> r;
+  return r;
+}
+
+inline uint64_t next_resource_id() {
+  static std::atomic<uint64_t> id{0};
+  return ++id;
+}
+
+} // namespace thread_cache_detail
+
+class thread_caching_resource : public std::pmr::memory_resource {
+public:
+  explicit thread_caching_resource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : id_(thread_cache_detail::next_resource_id()), upstream_(upstream) {
+    std::lock_guard<std::mutex> lock(thread_cache_detail::registry_mutex());
+    thread_cache_detail::registry().emplace(id_, this);
+  }
+
+  thread_caching_resource(const thread_caching_resource &) = delete;
+  thread_caching_resource &operator=(const thread_caching_resource &) = delete;
+
+  // every block must have been deallocated; threads still holding caches
+  // simply forget them
+  ~thread_caching_resource() override {
+    {
+      std::lock_guard<std::mutex> lock(thread_cache_detail::registry_mutex());
+      thread_cache_detail::registry().erase(id_);
+    }
+    for (void *chunk : chunks_) {
+      upstream_->deallocate(chunk, thread_cache_detail::kChunkSize, thread_cache_detail::kChunkAlign);
+    }
+  }
+
+  std::pmr::memory_resource *upstream_resource() const noexcept { return upstream_; }
+
+  // batches moved from/to the central pool, to see how often threads
+  // leave their caches
+  size_t central_refills() const noexcept { return refills_.load(std::memory_order_relaxed); }
+  size_t central_returns() const noexcept { return returns_.load(std::memory_order_relaxed); }
+
+  // moves the calling thread's cached blocks to the central pool
+  void flush_thread_cache() {
+    auto &caches = thread_cache_detail::local_caches();
+    for (auto &e : caches.entries) {
+      if (e.id == id_) flush(e.cache);
+    }
+  }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    using namespace thread_cache_detail;
+    int c = size_class(bytes, alignment);
+    if (c < 0) {
+      std::lock_guard<std::mutex> lock(upstream_mutex_);
+      return upstream_->allocate(bytes, alignment);
+    }
+    block_list &list = cache()->lists[c];
+    if (!list.head) refill(c, list);
+    free_block *b = list.head;
+    list.head = b->next;
+    --list.count;
+    return b;
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    using namespace thread_cache_detail;
+    int c = size_class(bytes, alignment);
+    if (c < 0) {
+      std::lock_guard<std::mutex> lock(upstream_mutex_);
+      upstream_->deallocate(p, bytes, alignment);
+      return;
+    }
+    block_list &list = cache()->lists[c];
+    list.head = ::new (p) free_block{list.head};
+    if (++list.count >= 2 * batch_size(c)) release(c, list);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+  friend struct thread_cache_detail::thread_caches;
+
+  struct central_list {
+    std::mutex mutex;
+    std::vector<thread_cache_detail::block_list> batches;
+  };
+
+  thread_cache_detail::thread_cache *cache() {
+    auto &caches = thread_cache_detail::local_caches();
+    if (caches.last_id == id_) return caches.last;
+    thread_cache_detail::thread_cache *found = nullptr;
+    for (auto &e : caches.entries) {
+      if (e.id == id_) found = e.cache;
+    }
+    if (!found) {
+      // first use on this thread: also forget destroyed resources
+      {
+        std::lock_guard<std::mutex> lock(thread_cache_detail::registry_mutex());
+        auto &live = thread_cache_detail::registry();
+        caches.entries.erase(std::remove_if(caches.entries.begin(), caches.entries.end(),
+                                            [&](const auto &e) { return live.count(e.id) == 0; }),
+                             caches.entries.end());
+      }
+      found = new_cache();
+      caches.entries.push_back({id_, found});
+    }
+    caches.last_id = id_;
+    caches.last = found;
+    return found;
+  }
+
+  thread_cache_detail::thread_cache *new_cache() {
+    std::lock_guard<std::mutex> lock(caches_mutex_);
+    if (!idle_caches_.empty()) {
+      auto c = idle_caches_.back();
+      idle_caches_.pop_back();
+      return c;
+    }
+    caches_.push_back(std::make_unique<thread_cache_detail::thread_cache>());
+    return caches_.back().get();
+  }
+
+  // called from the exiting thread with the registry locked, so the
+  // resource cannot be destroyed meanwhile
+  void retire(thread_cache_detail::thread_cache *c) {
+    flush(c);
+    std::lock_guard<std::mutex> lock(caches_mutex_);
+    idle_caches_.push_back(c);
+  }
+
+  void flush(thread_cache_detail::thread_cache *cache) {
+    for (int c = 0; c < thread_cache_detail::kClassCount; ++c) {
+      auto &list = cache->lists[c];
+      if (!list.head) continue;
+      std::lock_guard<std::mutex> lock(central_[c].mutex);
+      central_[c].batches.push_back(list);
+      list = {};
+    }
+  }
+
+  void refill(int c, thread_cache_detail::block_list &list) {
+    refills_.fetch_add(1, std::memory_order_relaxed);
+    central_list &central = central_[c];
+    {
+      std::lock_guard<std::mutex> lock(central.mutex);
+      if (!central.batches.empty()) {
+        list = central.batches.back();
+        central.batches.pop_back();
+        return;
+      }
+    }
+    carve_chunk(c, list);
+  }
+
+  // splits a new chunk into batches: one for the caller, the rest central
+  void carve_chunk(int c, thread_cache_detail::block_list &list) {
+    using namespace thread_cache_detail;
+    std::byte *chunk;
+    {
+      std::lock_guard<std::mutex> lock(upstream_mutex_);
+      chunk = static_cast<std::byte *>(upstream_->allocate(kChunkSize, kChunkAlign));
+      chunks_.push_back(chunk);
+    }
+    const size_t size = block_size(c);
+    const size_t blocks = kChunkSize / size;
+    const size_t batch = batch_size(c);
+    std::vector<block_list> batches;
+    block_list current;
+    for (size_t i = blocks; i-- > 0;) {
+      current.head = ::new (chunk + i * size) free_block{current.head};
+      if (++current.count == batch) {
+        batches.push_back(current);
+        current = {};
+      }
+    }
+    if (current.head) batches.push_back(current);
+    list = batches.back();
+    batches.pop_back();
+    std::lock_guard<std::mutex> lock(central_[c].mutex);
+    central_[c].batches.insert(central_[c].batches.end(), batches.begin(), batches.end());
+  }
+
+  // hands one batch of the thread list back to the central pool
+  void release(int c, thread_cache_detail::block_list &list) {
+    using namespace thread_cache_detail;
+    returns_.fetch_add(1, std::memory_order_relaxed);
+    block_list batch{list.head, batch_size(c)};
+    free_block *last = list.head;
+    for (size_t i = 1; i < batch.count; ++i) last = last->next;
+    list.head = last->next;
+    list.count -= batch.count;
+    last->next = nullptr;
+    std::lock_guard<std::mutex> lock(central_[c].mutex);
+    central_[c].batches.push_back(batch);
+  }
+
+  const uint64_t id_;
+  std::pmr::memory_resource *upstream_;
+  central_list central_[thread_cache_detail::kClassCount];
+
+  std::mutex upstream_mutex_;
+  std::vector<void *> chunks_;
+
+  std::mutex caches_mutex_;
+  std::vector<std::unique_ptr<thread_cache_detail::thread_cache>> caches_;
+  std::vector<thread_cache_detail::thread_cache *> idle_caches_;
+
+  std::atomic<size_t> refills_{0};
+  std::atomic<size_t> returns_{0};
+};
+
+inline thread_cache_detail::thread_caches::~thread_caches() {
+  std::lock_guard<std::mutex> lock(registry_mutex());
+  for (auto &e : entries) {
+    auto it = registry().find(e.id);
+    if (it != registry().end()) it->second->retire(e.cache);
+  }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// Batch dispatch over a collection of TaggedPointers.
+//
+// Calling dispatch() per element of a mixed collection jumps between types
+// on every handle, which the branch predictor cannot follow. DispatchBatch
+// first groups the pointers by tag with a (stable) counting sort on the tag
+// bits, then runs func over each homogeneous run, so every type's loop is
+// a tight, well predicted one. The visiting order is by type, then by
+// position; null handles are skipped.
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "tagged_pointer.h"
+
+// Reusable buffers, so repeated batches do not allocate
+struct BatchDispatchScratch {
+    std::vector<const void *> ptrs;
+    std::vector<size_t> offsets;
+};
+
+// deduces TaggedPointer<Ts...> from types derived from it (PrimitiveHandle)
+template <typename... Ts>
+TaggedPointer<Ts...> TaggedPointerBaseOf(const TaggedPointer<Ts...> &);
+
+template <typename... Ts>
+struct BatchDispatcher;
+
+template <typename... Ts>
+struct BatchDispatcher<TaggedPointer<Ts...>> {
+    static constexpr int numTags = TaggedPointer<Ts...>::num_tags();
+
+    // Counting sort of the handles' pointers by tag into scratch; afterwards
+    // the pointers of tag t are ptrs[offsets[t], offsets[t + 1])
+    template <typename Handle>
+    static void Group(const Handle *handles, size_t n, BatchDispatchScratch &scratch) {
+        scratch.offsets.assign(numTags + 1, 0);
+        size_t *offsets = scratch.offsets.data();
+        for (size_t i = 0; i < n; ++i)
+            ++offsets[handles[i].tag() + 1];
+        for (int t = 0; t < numTags; ++t)
+            offsets[t + 1] += offsets[t];
+
+        scratch.ptrs.resize(n);
+        // scatter through a copy of the starts, keeping offsets intact
+        size_t next[numTags];
+        for (int t = 0; t < numTags; ++t)
+            next[t] = offsets[t];
+        for (size_t i = 0; i < n; ++i)
+            scratch.ptrs[next[handles[i].tag()]++] = handles[i].ptr();
+    }
+
+    template <bool Const, typename F>
+    static void Run(const BatchDispatchScratch &scratch, F &func) {
+        RunTypes<Const, 1, Ts...>(scratch, func);
+    }
+
+  private:
+    template <bool Const, int Tag, typename T, typename... Rest, typename F>
+    static void RunTypes(const BatchDispatchScratch &scratch, F &func) {
+        using Ptr = std::conditional_t<Const, const T *, T *>;
+        const void *const *ptrs = scratch.ptrs.data();
+        for (size_t i = scratch.offsets[Tag], end = scratch.offsets[Tag + 1]; i < end; ++i)
+            func(static_cast<Ptr>(const_cast<void *>(ptrs[i])));
+        if constexpr (sizeof...(Rest) > 0)
+            RunTypes<Const, Tag + 1, Rest...>(scratch, func);
+    }
+};
+
+// Calls func(T *) for every non-null handle in [handles, handles + n), grouped
+// by type. Handle may be TaggedPointer<Ts...> or a type derived from it; for
+// const handles func receives const T *.
+template <typename Handle, typename F>
+void DispatchBatch(Handle *handles, size_t n, F &&func, BatchDispatchScratch &scratch) {
+    using Base = decltype(TaggedPointerBaseOf(std::declval<const Handle &>()));
+    using Dispatcher = BatchDispatcher<Base>;
+    Dispatcher::Group(handles, n, scratch);
+    Dispatcher::template Run<std::is_const_v<Handle>>(scratch, func);
+}
+
+template <typename Handle, typename F>
+void DispatchBatch(Handle *handles, size_t n, F &&func) {
+    BatchDispatchScratch scratch;
+    DispatchBatch(handles, n, std::forward<F>(func), scratch);
+}
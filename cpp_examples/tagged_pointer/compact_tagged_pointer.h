@@ -0,0 +1,158 @@
+#pragma once
+
+// 32-bit variant of TaggedPointer for programs holding so many handles that
+// their size matters. Instead of an address it stores the type tag in the
+// top bits and an element index in the rest; the address is
+// base<T>() + index, where base<T>() is the start of the array holding all
+// objects of type T (a std::vector<T>, a memory-mapped file, ...).
+//
+// The base table is static, one per CompactTaggedPointer<Ts...> type, and
+// must be set with set_base<T>() before handles are made or resolved; it may
+// be changed when the arrays move, the handles stay valid.
+// The interface matches TaggedPointer: is/cast/cast_or_nullptr/dispatch.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "tagged_pointer.h"
+
+template <typename... Ts>
+class CompactTaggedPointer {
+  private:
+    static constexpr int ComputeTagBits() {
+        int bits = 0;
+        while ((1u << bits) < sizeof...(Ts) + 1)
+            ++bits;
+        return bits;
+    }
+
+    static constexpr int tagBits = ComputeTagBits();
+    static constexpr int tagShift = 32 - tagBits;
+    static constexpr uint32_t indexMask = (uint32_t{1} << tagShift) - 1;
+
+  public:
+    static_assert(tagBits < 32, "Too many tagged pointer types");
+
+    // largest index a handle can hold
+    static constexpr uint32_t max_index() { return indexMask; }
+
+    CompactTaggedPointer() = default;
+    CompactTaggedPointer(std::nullptr_t) {}
+
+    template <typename T>
+    explicit CompactTaggedPointer(T *ptr) {
+        set(ptr);
+    }
+
+    template <typename T>
+    void set(T *ptr) {
+        if (!ptr) {
+            bits_ = 0;
+            return;
+        }
+        const std::remove_cv_t<T> *base = CompactTaggedPointer::base<T>();
+        assert(base && ptr >= base && "Pointer is not in the array of its type");
+        set_index<T>(static_cast<size_t>(ptr - base));
+    }
+
+    template <typename T>
+    void set_index(size_t index) {
+        assert(index <= indexMask && "Index does not fit in the handle");
+        bits_ = (uint32_t(type_index<T>()) << tagShift) | uint32_t(index);
+    }
+
+    template <typename T>
+    static CompactTaggedPointer make(size_t index) {
+        CompactTaggedPointer h;
+        h.set_index<T>(index);
+        return h;
+    }
+
+    template <typename T>
+    static void set_base(T *base) {
+        bases_[type_index<T>()] = const_cast<std::remove_cv_t<T> *>(base);
+    }
+
+    template <typename T>
+    static std::remove_cv_t<T> *base() {
+        return static_cast<std::remove_cv_t<T> *>(bases_[type_index<T>()]);
+    }
+
+    template <typename T>
+    static constexpr int type_index() {
+        return 1 + TypeIndex<std::remove_cv_t<T>, Ts...>();
+    }
+
+    static constexpr int max_tag() { return sizeof...(Ts); }
+    static constexpr int num_tags() { return max_tag() + 1; }
+
+    int tag() const { return static_cast<int>(bits_ >> tagShift); }
+    uint32_t index() const { return bits_ & indexMask; }
+    uint32_t bits() const { return bits_; }
+
+    void *ptr() { return tag() ? Resolve(tag(), index()) : nullptr; }
+    const void *ptr() const { return tag() ? Resolve(tag(), index()) : nullptr; }
+
+    explicit operator bool() const { return bits_ != 0; }
+
+    template <typename T>
+    bool is() const {
+        return tag() == type_index<T>();
+    }
+
+    template <typename T>
+    T *cast() {
+        assert(is<T>());
+        return base<T>() + index();
+    }
+
+    template <typename T>
+    const T *cast() const {
+        assert(is<T>());
+        return base<T>() + index();
+    }
+
+    template <typename T>
+    T *cast_or_nullptr() {
+        return is<T>() ? cast<T>() : nullptr;
+    }
+
+    template <typename T>
+    const T *cast_or_nullptr() const {
+        return is<T>() ? cast<T>() : nullptr;
+    }
+
+    template <typename F>
+    decltype(auto) dispatch(F &&func) {
+        assert(tag() != 0);
+        if constexpr (sizeof...(Ts) <= 2)
+            return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+        else
+            return DispatchJump<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+    }
+
+    template <typename F>
+    decltype(auto) dispatch(F &&func) const {
+        assert(tag() != 0);
+        if constexpr (sizeof...(Ts) <= 2)
+            return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+        else
+            return DispatchJump<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+    }
+
+  private:
+    // element size per tag, so resolving needs no dispatch
+    static constexpr size_t sizes_[] = {0, sizeof(Ts)...};
+
+    static void *Resolve(int tag, uint32_t index) {
+        assert(bases_[tag] && "Base of this type was not set");
+        return static_cast<char *>(bases_[tag]) + size_t(index) * sizes_[tag];
+    }
+
+    static inline void *bases_[sizeof...(Ts) + 1] = {};
+
+    uint32_t bits_ = 0;
+};
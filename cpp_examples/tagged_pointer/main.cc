@@ -4,132 +4,12 @@
 #include <iostream>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
-template <typename>
-inline constexpr bool always_false_v = false;
-
-template <typename T, typename First, typename... Rest>
-constexpr int TypeIndex() {
-    if constexpr (std::is_same_v<T, First>) {
-        return 0;
-    } else if constexpr (sizeof...(Rest) > 0) {
-        return 1 + TypeIndex<T, Rest...>();
-    } else {
-        static_assert(always_false_v<T>, "Type is not in TaggedPointer type list");
-    }
-}
-
-template <typename F, typename T, typename... Rest>
-decltype(auto) DispatchCPU(F &&func, void *ptr, int index) {
-    if (index == 0)
-        return std::forward<F>(func)(static_cast<T *>(ptr));
-
-    if constexpr (sizeof...(Rest) > 0) {
-        return DispatchCPU<F, Rest...>(std::forward<F>(func), ptr, index - 1);
-    } else {
-        assert(false && "Invalid tag index");
-        return std::forward<F>(func)(static_cast<T *>(ptr));
-    }
-}
-
-template <typename F, typename T, typename... Rest>
-decltype(auto) DispatchCPU(F &&func, const void *ptr, int index) {
-    if (index == 0)
-        return std::forward<F>(func)(static_cast<const T *>(ptr));
-
-    if constexpr (sizeof...(Rest) > 0) {
-        return DispatchCPU<F, Rest...>(std::forward<F>(func), ptr, index - 1);
-    } else {
-        assert(false && "Invalid tag index");
-        return std::forward<F>(func)(static_cast<const T *>(ptr));
-    }
-}
-
-template <typename... Ts>
-class TaggedPointer {
-  private:
-    static constexpr int tagShift = 57;
-    static constexpr int tagBits = 64 - tagShift;
-    static constexpr uint64_t tagMask = ((uint64_t{1} << tagBits) - 1) << tagShift;
-    static constexpr uint64_t ptrMask = ~tagMask;
-
-  public:
-    static_assert(sizeof(uintptr_t) <= sizeof(uint64_t));
-    static_assert(sizeof...(Ts) < (1u << tagBits), "Too many tagged pointer types");
-
-    TaggedPointer() = default;
-    TaggedPointer(std::nullptr_t) {}
-
-    template <typename T>
-    explicit TaggedPointer(T *ptr) {
-        set(ptr);
-    }
-
-    template <typename T>
-    void set(T *ptr) {
-        const auto iptr = reinterpret_cast<uint64_t>(ptr);
-        assert((iptr & ptrMask) == iptr && "Pointer uses bits reserved for tag");
-
-        const auto typeTag = static_cast<uint64_t>(type_index<T>());
-        bits_ = iptr | (typeTag << tagShift);
-    }
-
-    template <typename T>
-    static constexpr int type_index() {
-        return 1 + TypeIndex<std::remove_cv_t<T>, Ts...>();
-    }
-
-    static constexpr int max_tag() { return sizeof...(Ts); }
-    static constexpr int num_tags() { return max_tag() + 1; }
-
-    int tag() const { return static_cast<int>((bits_ & tagMask) >> tagShift); }
-    void *ptr() { return reinterpret_cast<void *>(bits_ & ptrMask); }
-    const void *ptr() const { return reinterpret_cast<const void *>(bits_ & ptrMask); }
-
-    explicit operator bool() const { return ptr() != nullptr; }
-
-    template <typename T>
-    bool is() const {
-        return tag() == type_index<T>();
-    }
-
-    template <typename T>
-    T *cast() {
-        assert(is<T>());
-        return static_cast<T *>(ptr());
-    }
-
-    template <typename T>
-    const T *cast() const {
-        assert(is<T>());
-        return static_cast<const T *>(ptr());
-    }
-
-    template <typename T>
-    T *cast_or_nullptr() {
-        return is<T>() ? static_cast<T *>(ptr()) : nullptr;
-    }
-
-    template <typename T>
-    const T *cast_or_nullptr() const {
-        return is<T>() ? static_cast<const T *>(ptr()) : nullptr;
-    }
-
-    template <typename F>
-    decltype(auto) dispatch(F &&func) {
-        assert(ptr() != nullptr);
-        return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
-    }
-
-    template <typename F>
-    decltype(auto) dispatch(F &&func) const {
-        assert(ptr() != nullptr);
-        return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
-    }
-
-  private:
-    uint64_t bits_ = 0;
-};
+#include "batch_dispatch.h"
+#include "compact_tagged_pointer.h"
+#include "tagged_pointer.h"
+#include "tagged_pool.h"
 
 struct Sphere {
     int id() const { return 1; }
@@ -236,6 +116,12 @@ int main() {
         constShape.dispatch([&](const auto *p) { rawVoidSum += p->id(); });
         assert(rawVoidSum == 5);
 
+        // references come back as references through the dispatch table
+        int counter = 0;
+        int &counterRef = shape.dispatch([&](auto *) -> int & { return counter; });
+        counterRef = 7;
+        assert(counter == 7);
+
         shape.set(&sphere);
         assert(shape.ptr() == &sphere);
         assert(shape.tag() == ShapePtr::type_index<Sphere>());
@@ -269,6 +155,128 @@ int main() {
     }
     // region: Handle Test End
 
+    // region: Batch Test
+    {
+        Sphere sphere;
+        Triangle tri;
+        Curve curve;
+        std::vector<PrimitiveHandle> handles = {
+            PrimitiveHandle(&curve), PrimitiveHandle(&sphere), PrimitiveHandle(nullptr),
+            PrimitiveHandle(&tri),   PrimitiveHandle(&curve),  PrimitiveHandle(&sphere)};
+
+        // grouped by type in declaration order, null handles skipped
+        int batchLog = 0;
+        DispatchBatch(handles.data(), handles.size(), [&](auto *p) { p->visit(batchLog); });
+        assert(batchLog == 11233);
+
+        const std::vector<PrimitiveHandle> &constHandles = handles;
+        BatchDispatchScratch scratch;
+        int batchSum = 0;
+        DispatchBatch(constHandles.data(), constHandles.size(),
+                      [&](const auto *p) { batchSum += p->id(); }, scratch);
+        assert(batchSum == 10);
+
+        // the scratch is reused by the next batch
+        batchLog = 0;
+        DispatchBatch(handles.data(), 2, [&](const auto *p) { p->inspect(batchLog); }, scratch);
+        assert(batchLog == 13);
+    }
+    // region: Batch Test End
+
+    // region: Pool Test
+    {
+        using ShapePool = TaggedPool<Sphere, Triangle, Curve>;
+        ShapePool pool;
+        std::vector<PrimitiveHandle> handles;
+        for (int i = 0; i < 3000; ++i) {
+            ShapePool::Handle h = i % 3 == 0   ? pool.emplace<Sphere>()
+                                  : i % 3 == 1 ? pool.emplace<Triangle>()
+                                               : pool.emplace<Curve>();
+            handles.push_back(PrimitiveHandle(nullptr));
+            static_cast<ShapePool::Handle &>(handles.back()) = h;
+        }
+        assert(pool.size() == 3000);
+        assert(pool.size<Triangle>() == 1000);
+        assert(handles[4].id() == 2);
+
+        // objects of a type are contiguous within a chunk
+        assert(handles[3].cast<Sphere>() == handles[0].cast<Sphere>() + 1);
+
+        int sum = 0;
+        pool.for_each<Curve>([&](Curve &c) { sum += c.id(); });
+        assert(sum == 3000);
+        sum = 0;
+        pool.for_each_all([&](auto &p) { sum += p.id(); });
+        assert(sum == 6000);
+
+        // erase every other handle, compact, then patch the survivors
+        std::vector<PrimitiveHandle> kept;
+        for (size_t i = 0; i < handles.size(); ++i) {
+            if (i % 2)
+                pool.erase(handles[i]);
+            else
+                kept.push_back(handles[i]);
+        }
+        assert(pool.size() == 1500);
+
+        auto remap = pool.compact();
+        assert(remap.size() > 0);
+        remap.apply(kept.data(), kept.size());
+        sum = 0;
+        for (const auto &h : kept)
+            h.add_id_to(sum);
+        assert(sum == 3000);
+        // after compaction the survivors of a type are packed in order
+        [[maybe_unused]] Sphere *first = kept[0].cast<Sphere>();
+        assert(kept[3].cast<Sphere>() == first + 1);
+        sum = 0;
+        pool.for_each_all([&](auto &p) { sum += p.id(); });
+        assert(sum == 3000);
+    }
+    // region: Pool Test End
+
+    // region: Compact Test
+    {
+        using CompactShape = CompactTaggedPointer<Sphere, Triangle, Curve>;
+        static_assert(sizeof(CompactShape) == 4);
+        assert(CompactShape::max_index() == (1u << 30) - 1);
+
+        std::vector<Sphere> spheres(4);
+        std::vector<Triangle> triangles(4);
+        std::vector<Curve> curves(4);
+        CompactShape::set_base(spheres.data());
+        CompactShape::set_base(triangles.data());
+        CompactShape::set_base(curves.data());
+
+        CompactShape empty;
+        assert(!empty);
+        assert(empty.ptr() == nullptr);
+        assert(empty.tag() == 0);
+
+        CompactShape shape(&triangles[2]);
+        assert(shape);
+        assert(shape.index() == 2);
+        assert(shape.tag() == CompactShape::type_index<Triangle>());
+        assert(shape.ptr() == &triangles[2]);
+        assert(shape.is<Triangle>());
+        assert(!shape.is<Curve>());
+        assert(shape.cast<Triangle>() == &triangles[2]);
+        assert(shape.cast_or_nullptr<Sphere>() == nullptr);
+        assert(shape.dispatch([](auto *p) { return p->id(); }) == 2);
+
+        const CompactShape constShape = CompactShape::make<Curve>(3);
+        assert(constShape.cast<Curve>() == &curves[3]);
+        int compactLog = 0;
+        constShape.dispatch([&](const auto *p) { p->inspect(compactLog); });
+        assert(compactLog == 3);
+
+        // the arrays may move, handles follow the base table
+        curves.resize(1000);
+        CompactShape::set_base(curves.data());
+        assert(constShape.cast<Curve>() == &curves[3]);
+    }
+    // region: Compact Test End
+
     std::cout << "tagged pointer example passed\n";
     return 0;
 }
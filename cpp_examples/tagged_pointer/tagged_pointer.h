@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+template <typename>
+inline constexpr bool always_false_v = false;
+
+template <typename T, typename First, typename... Rest>
+constexpr int TypeIndex() {
+    if constexpr (std::is_same_v<T, First>) {
+        return 0;
+    } else if constexpr (sizeof...(Rest) > 0) {
+        return 1 + TypeIndex<T, Rest...>();
+    } else {
+        static_assert(always_false_v<T>, "Type is not in TaggedPointer type list");
+    }
+}
+
+template <typename F, typename T, typename... Rest>
+decltype(auto) DispatchCPU(F &&func, void *ptr, int index) {
+    if (index == 0)
+        return std::forward<F>(func)(static_cast<T *>(ptr));
+
+    if constexpr (sizeof...(Rest) > 0) {
+        return DispatchCPU<F, Rest...>(std::forward<F>(func), ptr, index - 1);
+    } else {
+        assert(false && "Invalid tag index");
+        return std::forward<F>(func)(static_cast<T *>(ptr));
+    }
+}
+
+template <typename F, typename T, typename... Rest>
+decltype(auto) DispatchCPU(F &&func, const void *ptr, int index) {
+    if (index == 0)
+        return std::forward<F>(func)(static_cast<const T *>(ptr));
+
+    if constexpr (sizeof...(Rest) > 0) {
+        return DispatchCPU<F, Rest...>(std::forward<F>(func), ptr, index - 1);
+    } else {
+        assert(false && "Invalid tag index");
+        return std::forward<F>(func)(static_cast<const T *>(ptr));
+    }
+}
+
+// Constant-time dispatch: one indirect call through a constexpr table with
+// a thunk per type, instead of DispatchCPU's compare per type. The return
+// type is the one func has for the first type, as with DispatchCPU.
+template <typename R, typename F, typename T>
+R DispatchThunk(F &func, void *ptr) {
+    return func(static_cast<T *>(ptr));
+}
+
+template <typename R, typename F, typename T>
+R DispatchThunkConst(F &func, const void *ptr) {
+    return func(static_cast<const T *>(ptr));
+}
+
+template <typename F, typename T, typename... Rest>
+decltype(auto) DispatchJump(F &&func, void *ptr, int index) {
+    using Func = std::remove_reference_t<F>;
+    using R = decltype(func(static_cast<T *>(ptr)));
+    static constexpr R (*table[])(Func &, void *) = {&DispatchThunk<R, Func, T>,
+                                                    &DispatchThunk<R, Func, Rest>...};
+    assert(index >= 0 && index <= int(sizeof...(Rest)) && "Invalid tag index");
+    return table[index](func, ptr);
+}
+
+template <typename F, typename T, typename... Rest>
+decltype(auto) DispatchJump(F &&func, const void *ptr, int index) {
+    using Func = std::remove_reference_t<F>;
+    using R = decltype(func(static_cast<const T *>(ptr)));
+    static constexpr R (*table[])(Func &, const void *) = {&DispatchThunkConst<R, Func, T>,
+                                                          &DispatchThunkConst<R, Func, Rest>...};
+    assert(index >= 0 && index <= int(sizeof...(Rest)) && "Invalid tag index");
+    return table[index](func, ptr);
+}
+
+template <typename... Ts>
+class TaggedPointer {
+  private:
+    static constexpr int tagShift = 57;
+    static constexpr int tagBits = 64 - tagShift;
+    static constexpr uint64_t tagMask = ((uint64_t{1} << tagBits) - 1) << tagShift;
+    static constexpr uint64_t ptrMask = ~tagMask;
+
+  public:
+    static_assert(sizeof(uintptr_t) <= sizeof(uint64_t));
+    static_assert(sizeof...(Ts) < (1u << tagBits), "Too many tagged pointer types");
+
+    TaggedPointer() = default;
+    TaggedPointer(std::nullptr_t) {}
+
+    template <typename T>
+    explicit TaggedPointer(T *ptr) {
+        set(ptr);
+    }
+
+    template <typename T>
+    void set(T *ptr) {
+        const auto iptr = reinterpret_cast<uint64_t>(ptr);
+        assert((iptr & ptrMask) == iptr && "Pointer uses bits reserved for tag");
+
+        const auto typeTag = static_cast<uint64_t>(type_index<T>());
+        bits_ = iptr | (typeTag << tagShift);
+    }
+
+    template <typename T>
+    static constexpr int type_index() {
+        return 1 + TypeIndex<std::remove_cv_t<T>, Ts...>();
+    }
+
+    static constexpr int max_tag() { return sizeof...(Ts); }
+    static constexpr int num_tags() { return max_tag() + 1; }
+
+    int tag() const { return static_cast<int>((bits_ & tagMask) >> tagShift); }
+    void *ptr() { return reinterpret_cast<void *>(bits_ & ptrMask); }
+    const void *ptr() const { return reinterpret_cast<const void *>(bits_ & ptrMask); }
+
+    explicit operator bool() const { return ptr() != nullptr; }
+
+    template <typename T>
+    bool is() const {
+        return tag() == type_index<T>();
+    }
+
+    template <typename T>
+    T *cast() {
+        assert(is<T>());
+        return static_cast<T *>(ptr());
+    }
+
+    template <typename T>
+    const T *cast() const {
+        assert(is<T>());
+        return static_cast<const T *>(ptr());
+    }
+
+    template <typename T>
+    T *cast_or_nullptr() {
+        return is<T>() ? static_cast<T *>(ptr()) : nullptr;
+    }
+
+    template <typename T>
+    const T *cast_or_nullptr() const {
+        return is<T>() ? static_cast<const T *>(ptr()) : nullptr;
+    }
+
+    // Two types are one compare, cheaper than the indirect call of the table
+    template <typename F>
+    decltype(auto) dispatch(F &&func) {
+        assert(ptr() != nullptr);
+        if constexpr (sizeof...(Ts) <= 2)
+            return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+        else
+            return DispatchJump<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+    }
+
+    template <typename F>
+    decltype(auto) dispatch(F &&func) const {
+        assert(ptr() != nullptr);
+        if constexpr (sizeof...(Ts) <= 2)
+            return DispatchCPU<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+        else
+            return DispatchJump<F, Ts...>(std::forward<F>(func), ptr(), tag() - 1);
+    }
+
+  private:
+    uint64_t bits_ = 0;
+};
@@ -0,0 +1,397 @@
+// Mixed collection of handles to three shape types, shuffled so consecutive
+// handles rarely share a type; each benchmark sums the shapes' areas.
+//   per_element_dispatch  handle.dispatch() for every handle
+//   batch_dispatch        DispatchBatch, grouping time included
+//   virtual_call          the same shapes behind an abstract base class
+// The "traversal" suite walks the same shapes allocated one by one on the
+// heap and stored in a TaggedPool, through handles and per type.
+// The "8 vs 4 byte handles" suite compares TaggedPointer with
+// CompactTaggedPointer: counting tags only reads the handle array (8 or 4
+// bytes per handle), summing areas also resolves them.
+// The "N types" suites compare the cost of a single dispatch over 2, 8 and
+// 32 types: DispatchCPU's compare chain against DispatchJump's table.
+// Uses the picobench runner of ../benchmark, e.g. --samples=5 --json=out.json
+
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "batch_dispatch.h"
+#include "compact_tagged_pointer.h"
+#include "tagged_pointer.h"
+#include "tagged_pool.h"
+
+struct Sphere {
+    float radius;
+    float Area() const { return 4.0f * 3.14159265f * radius * radius; }
+};
+
+struct Triangle {
+    float p[3][3];
+    float Area() const {
+        float e1[3], e2[3];
+        for (int i = 0; i < 3; ++i) {
+            e1[i] = p[1][i] - p[0][i];
+            e2[i] = p[2][i] - p[0][i];
+        }
+        float cx = e1[1] * e2[2] - e1[2] * e2[1];
+        float cy = e1[2] * e2[0] - e1[0] * e2[2];
+        float cz = e1[0] * e2[1] - e1[1] * e2[0];
+        return 0.5f * std::sqrt(cx * cx + cy * cy + cz * cz);
+    }
+};
+
+struct Curve {
+    float width0, width1, length;
+    float Area() const { return 0.5f * (width0 + width1) * length; }
+};
+
+using ShapeHandle = TaggedPointer<Sphere, Triangle, Curve>;
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual float Area() const = 0;
+};
+
+template <typename T>
+struct VirtualShape : Shape {
+    explicit VirtualShape(const T &s) : shape(s) {}
+    float Area() const override { return shape.Area(); }
+    T shape;
+};
+
+// n shapes of random type, stored per type as a renderer would keep them,
+// referenced in random order
+struct Scene {
+    std::vector<Sphere> spheres;
+    std::vector<Triangle> triangles;
+    std::vector<Curve> curves;
+    std::vector<ShapeHandle> handles;
+    std::vector<std::unique_ptr<Shape>> objects;
+    std::vector<const Shape *> virtualShapes;
+
+    explicit Scene(size_t n) {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> u(0.5f, 1.5f);
+        std::vector<int> types(n);
+        for (auto &t : types) t = int(gen() % 3);
+        for (int t : types) {
+            if (t == 0) spheres.push_back({u(gen)});
+            if (t == 1) triangles.push_back({{{0, 0, 0}, {u(gen), 0, 0}, {0, u(gen), 0}}});
+            if (t == 2) curves.push_back({u(gen), u(gen), u(gen)});
+        }
+        for (auto &s : spheres) handles.emplace_back(&s);
+        for (auto &s : triangles) handles.emplace_back(&s);
+        for (auto &s : curves) handles.emplace_back(&s);
+        std::shuffle(handles.begin(), handles.end(), gen);
+        for (auto h : handles) {
+            h.dispatch([&](auto *p) {
+                using T = std::remove_pointer_t<decltype(p)>;
+                objects.push_back(std::make_unique<VirtualShape<T>>(*p));
+            });
+            virtualShapes.push_back(objects.back().get());
+        }
+    }
+};
+
+static void Report(picobench::state &s, float sum) { s.set_result(picobench::result_t(sum)); }
+
+void per_element_dispatch(picobench::state &s) {
+    Scene scene(s.iterations());
+    float sum = 0;
+    {
+        bench::perf_scope scope(s);
+        for (const auto &h : scene.handles) sum += h.dispatch([](const auto *p) { return p->Area(); });
+    }
+    Report(s, sum);
+}
+
+void batch_dispatch(picobench::state &s) {
+    Scene scene(s.iterations());
+    BatchDispatchScratch scratch;
+    scratch.ptrs.reserve(scene.handles.size());
+    float sum = 0;
+    {
+        bench::perf_scope scope(s);
+        DispatchBatch(scene.handles.data(), scene.handles.size(), [&](const auto *p) { sum += p->Area(); },
+                      scratch);
+    }
+    Report(s, sum);
+}
+
+void virtual_call(picobench::state &s) {
+    Scene scene(s.iterations());
+    float sum = 0;
+    {
+        bench::perf_scope scope(s);
+        for (const Shape *p : scene.virtualShapes) sum += p->Area();
+    }
+    Report(s, sum);
+}
+
+PICOBENCH(per_element_dispatch).iterations({65536, 1048576}).baseline();
+PICOBENCH(batch_dispatch).iterations({65536, 1048576});
+PICOBENCH(virtual_call).iterations({65536, 1048576});
+
+// N distinct types, each with its own constant so calls cannot be merged
+template <int I>
+struct Leaf {
+    float value;
+    float Eval() const { return value * float(I + 1); }
+};
+
+template <typename Seq>
+struct LeafHandleOf;
+
+template <int... Is>
+struct LeafHandleOf<std::integer_sequence<int, Is...>> {
+    using type = TaggedPointer<Leaf<Is>...>;
+    static constexpr size_t size = sizeof...(Is);
+    // one object per type is enough: dispatch cost, not memory, is measured
+    std::tuple<Leaf<Is>...> leaves{Leaf<Is>{1.0f}...};
+
+    type Handle(int typeIndex) {
+        type h;
+        ((typeIndex == Is ? h.set(&std::get<Leaf<Is>>(leaves)) : void()), ...);
+        return h;
+    }
+};
+
+template <int N>
+using LeafSet = LeafHandleOf<std::make_integer_sequence<int, N>>;
+
+template <typename Set>
+std::vector<typename Set::type> RandomLeafHandles(Set &set, size_t n) {
+    std::mt19937 gen(1234);
+    std::vector<typename Set::type> handles(n);
+    for (auto &h : handles) h = set.Handle(int(gen() % Set::size));
+    return handles;
+}
+
+template <typename Handle, typename... Ts>
+float SumRecursive(const std::vector<Handle> &handles, TaggedPointer<Ts...> *) {
+    auto eval = [](const auto *p) { return p->Eval(); };
+    float sum = 0;
+    for (const auto &h : handles) sum += DispatchCPU<decltype(eval) &, Ts...>(eval, h.ptr(), h.tag() - 1);
+    return sum;
+}
+
+template <int N>
+void recursive_chain(picobench::state &s) {
+    LeafSet<N> set;
+    auto handles = RandomLeafHandles(set, s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumRecursive(handles, static_cast<typename LeafSet<N>::type *>(nullptr));
+    }
+    Report(s, sum);
+}
+
+template <typename Handle, typename... Ts>
+float SumJump(const std::vector<Handle> &handles, TaggedPointer<Ts...> *) {
+    auto eval = [](const auto *p) { return p->Eval(); };
+    float sum = 0;
+    for (const auto &h : handles) sum += DispatchJump<decltype(eval) &, Ts...>(eval, h.ptr(), h.tag() - 1);
+    return sum;
+}
+
+template <int N>
+void jump_table(picobench::state &s) {
+    LeafSet<N> set;
+    auto handles = RandomLeafHandles(set, s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumJump(handles, static_cast<typename LeafSet<N>::type *>(nullptr));
+    }
+    Report(s, sum);
+}
+
+template <int N>
+void RegisterDispatchSuite(const char *suite) {
+    using picobench::global_registry;
+    global_registry::set_bench_suite(suite);
+    global_registry::new_benchmark("recursive_chain", recursive_chain<N>).iterations({65536, 1048576}).baseline();
+    global_registry::new_benchmark("jump_table", jump_table<N>).iterations({65536, 1048576});
+}
+
+static int registered = [] {
+    RegisterDispatchSuite<2>("2 types");
+    RegisterDispatchSuite<8>("8 types");
+    RegisterDispatchSuite<32>("32 types");
+    return 0;
+}();
+
+// Shapes in creation order; heap objects are interleaved with other
+// allocations, as they would be in a program that loads a scene
+struct TraversalScene {
+    std::vector<int> types;
+    std::vector<ShapeHandle> heapHandles;
+    std::vector<std::unique_ptr<char[]>> heapNoise;
+    TaggedPool<Sphere, Triangle, Curve> pool;
+    std::vector<ShapeHandle> poolHandles;
+
+    explicit TraversalScene(size_t n) : types(n) {
+        std::mt19937 gen(1234);
+        for (auto &t : types) t = int(gen() % 3);
+        for (int t : types) {
+            heapNoise.emplace_back(new char[16 + gen() % 256]);
+            if (t == 0) {
+                heapHandles.emplace_back(new Sphere{1.0f});
+                poolHandles.push_back(pool.emplace<Sphere>(Sphere{1.0f}));
+            } else if (t == 1) {
+                Triangle tri{{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}};
+                heapHandles.emplace_back(new Triangle(tri));
+                poolHandles.push_back(pool.emplace<Triangle>(tri));
+            } else {
+                heapHandles.emplace_back(new Curve{1.0f, 0.5f, 2.0f});
+                poolHandles.push_back(pool.emplace<Curve>(Curve{1.0f, 0.5f, 2.0f}));
+            }
+        }
+    }
+
+    ~TraversalScene() {
+        for (auto h : heapHandles) h.dispatch([](auto *p) { delete p; });
+    }
+};
+
+static float SumAreas(const std::vector<ShapeHandle> &handles) {
+    float sum = 0;
+    for (const auto &h : handles) sum += h.dispatch([](const auto *p) { return p->Area(); });
+    return sum;
+}
+
+void heap_handles(picobench::state &s) {
+    TraversalScene scene(s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumAreas(scene.heapHandles);
+    }
+    Report(s, sum);
+}
+
+void pool_handles(picobench::state &s) {
+    TraversalScene scene(s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumAreas(scene.poolHandles);
+    }
+    Report(s, sum);
+}
+
+void pool_for_each(picobench::state &s) {
+    TraversalScene scene(s.iterations());
+    float sum = 0;
+    {
+        bench::perf_scope scope(s);
+        scene.pool.for_each_all([&](const auto &p) { sum += p.Area(); });
+    }
+    Report(s, sum);
+}
+
+PICOBENCH_SUITE("traversal");
+PICOBENCH(heap_handles).iterations({65536, 1048576}).baseline();
+PICOBENCH(pool_handles).iterations({65536, 1048576});
+PICOBENCH(pool_for_each).iterations({65536, 1048576});
+
+using CompactShapeHandle = CompactTaggedPointer<Sphere, Triangle, Curve>;
+static_assert(sizeof(ShapeHandle) == 8 && sizeof(CompactShapeHandle) == 4);
+
+// Shapes in one array per type, referenced in random order by both kinds
+// of handle
+struct HandleScene {
+    std::vector<Sphere> spheres;
+    std::vector<Triangle> triangles;
+    std::vector<Curve> curves;
+    std::vector<ShapeHandle> handles;
+    std::vector<CompactShapeHandle> compactHandles;
+
+    explicit HandleScene(size_t n) {
+        std::mt19937 gen(1234);
+        std::vector<int> types(n);
+        for (auto &t : types) t = int(gen() % 3);
+        for (int t : types) {
+            if (t == 0) spheres.push_back({1.0f});
+            if (t == 1) triangles.push_back({{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}});
+            if (t == 2) curves.push_back({1.0f, 0.5f, 2.0f});
+        }
+        CompactShapeHandle::set_base(spheres.data());
+        CompactShapeHandle::set_base(triangles.data());
+        CompactShapeHandle::set_base(curves.data());
+        for (auto &s : spheres) handles.emplace_back(&s);
+        for (auto &s : triangles) handles.emplace_back(&s);
+        for (auto &s : curves) handles.emplace_back(&s);
+        std::shuffle(handles.begin(), handles.end(), gen);
+        for (auto h : handles) h.dispatch([&](auto *p) { compactHandles.emplace_back(p); });
+    }
+};
+
+template <typename Handle>
+static size_t CountSpheres(const std::vector<Handle> &handles) {
+    size_t n = 0;
+    for (const auto &h : handles) n += h.template is<Sphere>();
+    return n;
+}
+
+template <typename Handle>
+static float SumHandleAreas(const std::vector<Handle> &handles) {
+    float sum = 0;
+    for (const auto &h : handles) sum += h.dispatch([](const auto *p) { return p->Area(); });
+    return sum;
+}
+
+void tagged_ptr_tags(picobench::state &s) {
+    HandleScene scene(s.iterations());
+    size_t n;
+    {
+        bench::perf_scope scope(s);
+        n = CountSpheres(scene.handles);
+    }
+    s.set_result(n);
+}
+
+void compact_tags(picobench::state &s) {
+    HandleScene scene(s.iterations());
+    size_t n;
+    {
+        bench::perf_scope scope(s);
+        n = CountSpheres(scene.compactHandles);
+    }
+    s.set_result(n);
+}
+
+void tagged_ptr_areas(picobench::state &s) {
+    HandleScene scene(s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumHandleAreas(scene.handles);
+    }
+    Report(s, sum);
+}
+
+void compact_areas(picobench::state &s) {
+    HandleScene scene(s.iterations());
+    float sum;
+    {
+        bench::perf_scope scope(s);
+        sum = SumHandleAreas(scene.compactHandles);
+    }
+    Report(s, sum);
+}
+
+PICOBENCH_SUITE("8 vs 4 byte handles");
+PICOBENCH(tagged_ptr_tags).iterations({1048576, 8388608}).baseline();
+PICOBENCH(compact_tags).iterations({1048576, 8388608});
+PICOBENCH(tagged_ptr_areas).iterations({1048576, 8388608});
+PICOBENCH(compact_areas).iterations({1048576, 8388608});
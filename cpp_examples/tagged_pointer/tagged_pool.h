@@ -0,0 +1,211 @@
+#pragma once
+
+// Storage for the objects TaggedPointer handles point to: one array per type
+// in Ts..., so objects of a type sit next to each other instead of wherever
+// the heap put them, and a per-type loop walks memory linearly.
+//
+// Each array grows in fixed-size chunks, so emplacing never moves objects
+// and handles stay valid until the object is erased or the pool compacted.
+// erase() only leaves a hole; compact() closes the holes while keeping the
+// order of the objects and returns the old -> new mapping of moved handles.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tagged_pointer.h"
+
+template <typename... Ts>
+class TaggedPool {
+  public:
+    using Handle = TaggedPointer<Ts...>;
+    static constexpr size_t chunkSize = 1024; // objects per chunk
+
+    // Old -> new handle of every object moved by compact()
+    class Remap {
+      public:
+        // handles of objects that did not move come back unchanged
+        Handle operator()(Handle h) const {
+            auto it = moved_.find(h.ptr());
+            return it == moved_.end() ? h : it->second;
+        }
+
+        template <typename H>
+        void apply(H *handles, size_t n) const {
+            for (size_t i = 0; i < n; ++i)
+                static_cast<Handle &>(handles[i]) = (*this)(handles[i]);
+        }
+
+        size_t size() const { return moved_.size(); }
+
+      private:
+        friend class TaggedPool;
+        std::unordered_map<const void *, Handle> moved_;
+    };
+
+    TaggedPool() = default;
+    TaggedPool(const TaggedPool &) = delete;
+    TaggedPool &operator=(const TaggedPool &) = delete;
+    ~TaggedPool() { clear(); }
+
+    template <typename T, typename... Args>
+    Handle emplace(Args &&...args) {
+        auto &a = array<T>();
+        size_t index = a.end;
+        if (index / chunkSize == a.chunks.size())
+            a.add_chunk();
+        T *p = ::new (a.slot(index)) T(std::forward<Args>(args)...);
+        a.alive(index) = 1;
+        ++a.end;
+        ++a.live;
+        return Handle(p);
+    }
+
+    // destroys the object; the slot stays empty until compact()
+    void erase(Handle h) {
+        assert(h);
+        h.dispatch([&](auto *p) {
+            using T = std::remove_pointer_t<decltype(p)>;
+            auto &a = array<T>();
+            size_t index = a.index_of(p);
+            assert(a.alive(index) && "Handle was already erased");
+            p->~T();
+            a.alive(index) = 0;
+            --a.live;
+        });
+    }
+
+    template <typename T>
+    size_t size() const {
+        return array<T>().live;
+    }
+
+    size_t size() const { return (size<Ts>() + ...); }
+
+    // calls func(T &) for the live objects of type T in insertion order
+    template <typename T, typename F>
+    void for_each(F &&func) {
+        auto &a = array<T>();
+        for (size_t c = 0; c < a.chunks.size(); ++c) {
+            auto &chunk = *a.chunks[c];
+            size_t n = std::min(chunkSize, a.end - c * chunkSize);
+            for (size_t i = 0; i < n; ++i) {
+                if (chunk.alive[i])
+                    func(*std::launder(reinterpret_cast<T *>(&chunk.slots[i])));
+            }
+        }
+    }
+
+    // calls func(T &) for every live object, one type after the other
+    template <typename F>
+    void for_each_all(F &&func) {
+        (for_each<Ts>(func), ...);
+    }
+
+    // Moves live objects down over the holes (order is kept) and frees the
+    // chunks that are no longer needed
+    Remap compact() {
+        Remap remap;
+        (compact_array<Ts>(remap), ...);
+        return remap;
+    }
+
+    void clear() { (clear_array<Ts>(), ...); }
+
+  private:
+    template <typename T>
+    struct Array {
+        struct alignas(T) Slot {
+            std::byte bytes[sizeof(T)];
+        };
+        struct Chunk {
+            Slot slots[chunkSize];
+            uint8_t alive[chunkSize] = {};
+        };
+
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        // (chunk address, chunk index) sorted by address, to find a handle's slot
+        std::vector<std::pair<uintptr_t, size_t>> bases;
+        size_t end = 0;  // slots in use, including holes
+        size_t live = 0; // objects
+
+        void add_chunk() {
+            chunks.push_back(std::make_unique<Chunk>());
+            std::pair<uintptr_t, size_t> base(reinterpret_cast<uintptr_t>(chunks.back()->slots),
+                                              chunks.size() - 1);
+            bases.insert(std::lower_bound(bases.begin(), bases.end(), base), base);
+        }
+
+        void shrink(size_t numChunks) {
+            chunks.resize(numChunks);
+            bases.erase(std::remove_if(bases.begin(), bases.end(),
+                                       [&](const auto &b) { return b.second >= numChunks; }),
+                        bases.end());
+        }
+
+        void *slot(size_t i) { return &chunks[i / chunkSize]->slots[i % chunkSize]; }
+        T *object(size_t i) { return std::launder(reinterpret_cast<T *>(slot(i))); }
+        uint8_t &alive(size_t i) { return chunks[i / chunkSize]->alive[i % chunkSize]; }
+
+        size_t index_of(const T *p) const {
+            auto addr = reinterpret_cast<uintptr_t>(p);
+            auto it = std::upper_bound(bases.begin(), bases.end(),
+                                       std::pair<uintptr_t, size_t>(addr, SIZE_MAX));
+            assert(it != bases.begin() && "Handle does not belong to this pool");
+            --it;
+            assert(addr < it->first + sizeof(Slot) * chunkSize && "Handle does not belong to this pool");
+            return it->second * chunkSize + (addr - it->first) / sizeof(Slot);
+        }
+    };
+
+    template <typename T>
+    Array<T> &array() {
+        return std::get<Array<T>>(arrays_);
+    }
+
+    template <typename T>
+    const Array<T> &array() const {
+        return std::get<Array<T>>(arrays_);
+    }
+
+    template <typename T>
+    void compact_array(Remap &remap) {
+        auto &a = array<T>();
+        size_t write = 0;
+        for (size_t read = 0; read < a.end; ++read) {
+            if (!a.alive(read))
+                continue;
+            if (read != write) {
+                T *from = a.object(read);
+                T *to = ::new (a.slot(write)) T(std::move(*from));
+                from->~T();
+                a.alive(read) = 0;
+                a.alive(write) = 1;
+                remap.moved_.emplace(from, Handle(to));
+            }
+            ++write;
+        }
+        a.end = write;
+        a.shrink((write + chunkSize - 1) / chunkSize);
+    }
+
+    template <typename T>
+    void clear_array() {
+        auto &a = array<T>();
+        for (size_t i = 0; i < a.end; ++i) {
+            if (a.alive(i))
+                a.object(i)->~T();
+        }
+        a.shrink(0);
+        a.end = a.live = 0;
+    }
+
+    std::tuple<Array<Ts>...> arrays_;
+};
@@ -19,12 +19,16 @@
 #ifndef LIB_FUTURE_H_
 #define LIB_FUTURE_H_
 
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
 #include <functional>
-#include <mutex>
 #include <memory>
-#include <condition_variable>
-
-#include <list>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // 总结future/promise实现的技巧
 // 需要由一个control block，内部至少包含一个条件变量cond,一个锁，一个value和一个bool complete
@@ -36,21 +40,232 @@
 //1. future支持添加回调函数
 //2. 支持错误码，所以错误码需要在回调/promise/future中传递
 
-typedef std::unique_lock<std::mutex> Lock;
+// 无锁版本（原来的互斥锁版本见 future_mutex.h）:
+// 1. status 是一个原子状态机 kPending -> kSetting -> kComplete -> kNotified，
+//    只有把 kPending 换成 kSetting 的那个线程可以写入结果，所以多次 setValue 依然只有第一次生效；
+//    回调都执行完以后变成 kNotified
+// 2. listeners 是一个无锁的侵入式栈，回调对象和链表节点在同一次分配里，
+//    完成以后栈顶被换成 kCompletedTag，之后 addListener 直接执行回调（快速路径）
+// 3. get 用 std::atomic::wait 等待 status（Linux 上是 futex），不再需要条件变量
+// 需要 C++20
+//
+// 组合:
+// 1. then(func) 在前一个 future 成功后执行 func(value)，返回新的 future；
+//    func 返回 Future 时会自动展开。失败（Result 不等于默认值）直接传递给新的 future，func 不执行
+// 2. then(executor, func) 把 func 交给 executor 执行，executor 是任何有 execute(task) 的对象，
+//    按值保存，所以应该是一个可以拷贝的句柄；
+//    前一个 future 的值在它的回调里交给任务（只能移动的值被移出来），所以消费型 get 不影响任务；
+//    不指定时使用 InlineExecutor，在完成前一个 future 的线程里直接执行
+//    （InlineExecutor 下一条很长的链会在 setValue 里逐级递归，链很深时应该使用线程池等 executor）
+// 3. whenAll / whenAny 把多个 future 合并成一个，whenAny 不接受空的 vector；
+//    和 co_await 一样，只能移动的值会从输入的 future 里移出来
+// 约定 Result 的默认值（setValue 使用的 DEFAULT_RESULT）表示成功
+//
+// 值的传递:
+// 1. 结果保存在 std::optional<Type> 里，失败时为空，Type 不需要默认构造，可以是只能移动的类型
+// 2. setValue(Type&&) 和 emplace(args...) 直接移动/构造到共享状态里，不再拷贝
+// 3. 回调的第二个参数可以是 const Type&（失败时传入默认构造的值，所以要求 Type 可以默认构造），
+//    也可以是 const std::optional<Type>&（失败时为空）
+// 4. get(Type&) 拷贝结果；std::move(future).get() 是消费型的，等回调执行完以后把值移出来，
+//    之后这个共享状态里的值就没有了，不能再 get，也不能在这个 future 自己的回调里调用
+//
+// 协程（配合 task.h 的 Task）:
+// co_await future 得到 std::pair<Result, Type>（Type 不能默认构造时是 std::pair<Result, std::optional<Type> >），
+// 只能移动的 Type 会被移出来，所以只能有一个消费者；已经完成时不挂起；
+// 否则把等待者的链表节点放在协程帧里的 awaiter 中，挂起时不需要分配内存，
+// 完成时在 setValue 的线程里恢复协程。协程挂起期间不能销毁协程帧
 
 namespace pulsar {
 
-// pulsar的Result是类似于错误码，可以用Enum
+template <typename Result, typename Type>
+class Promise;
+
+template <typename Result, typename Type>
+class Future;
+
+template <typename Result, typename Type>
+Future<Result, std::vector<Type> > whenAll(std::vector<Future<Result, Type> > futures);
+
+template <typename Result, typename Type>
+Future<Result, std::pair<size_t, Type> > whenAny(std::vector<Future<Result, Type> > futures);
+
+// 在当前线程直接执行
+struct InlineExecutor {
+    template <typename Task>
+    void execute(Task&& task) const {
+        task();
+    }
+};
+
+template <typename T>
+struct IsFuture : std::false_type {};
+
+template <typename Result, typename Type>
+struct IsFuture<Future<Result, Type> > : std::true_type {};
+
+// then 的结果类型：Future<Result, U> 展开成 U
+template <typename T>
+struct UnwrapFuture {
+    typedef T type;
+};
+
+template <typename Result, typename Type>
+struct UnwrapFuture<Future<Result, Type> > {
+    typedef Type type;
+};
+
 // type是值类型
 template <typename Result, typename Type>
 struct InternalState {
-    std::mutex mutex;
-    std::condition_variable condition;
-    Result result;
-    Type value;
-    bool complete;
-    // future支持添加回调
-    std::list<typename std::function<void(Result, const Type&)> > listeners;
+    // 侵入式链表节点，回调保存在派生类里
+    // 节点不一定是堆上分配的（见 ResumeNode），所以由派生类决定怎么释放
+    struct ListenerNode {
+        ListenerNode* next = nullptr;
+        // 执行回调并释放节点，之后不能再访问这个节点
+        virtual void run(Result result, std::optional<Type>& value) = 0;
+        // promise 没有设置结果就被销毁了：只释放节点
+        virtual void discard() = 0;
+
+       protected:
+        ~ListenerNode() = default;
+    };
+
+    template <typename Callback>
+    struct CallbackNode final : ListenerNode {
+        explicit CallbackNode(Callback&& cb) : callback(std::move(cb)) {}
+        void run(Result result, std::optional<Type>& value) override {
+            std::unique_ptr<CallbackNode> owner(this);
+            callback(result, value);
+        }
+        void discard() override { delete this; }
+        Callback callback;
+    };
+
+    // co_await 使用的节点，放在协程帧里，恢复协程就是它的回调
+    struct ResumeNode final : ListenerNode {
+        void run(Result, std::optional<Type>&) override { handle.resume(); }
+        void discard() override {}
+        std::coroutine_handle<> handle;
+    };
+
+    enum Status : uint32_t { kPending, kSetting, kComplete, kNotified };
+
+    // 栈顶等于这个值表示已经完成，不再接受新节点
+    static ListenerNode* completedTag() { return reinterpret_cast<ListenerNode*>(uintptr_t(1)); }
+
+    ~InternalState() {
+        ListenerNode* node = listeners.load(std::memory_order_acquire);
+        if (node == completedTag()) {
+            return;
+        }
+        // promise 没有设置结果就被销毁了，回调永远不会执行
+        while (node) {
+            ListenerNode* next = node->next;
+            node->discard();
+            node = next;
+        }
+    }
+
+    bool isComplete() const { return status.load(std::memory_order_acquire) >= kComplete; }
+
+    // 等到 status 不小于 until
+    void wait(uint32_t until = kComplete) const {
+        uint32_t s = status.load(std::memory_order_acquire);
+        while (s < until) {
+            status.wait(s, std::memory_order_acquire);
+            s = status.load(std::memory_order_acquire);
+        }
+    }
+
+    // 失败时传给 const Type& 回调的值
+    static const Type& emptyValue() {
+        static_assert(std::is_default_constructible_v<Type>,
+                      "Type 不能默认构造时，回调的参数应该是 const std::optional<Type>&");
+        static const Type empty{};
+        return empty;
+    }
+
+    // 把节点压栈；已经完成时返回 false，节点没有压栈，由调用者处理
+    bool push(ListenerNode* node) {
+        node->next = listeners.load(std::memory_order_acquire);
+        do {
+            if (node->next == completedTag()) {
+                return false;
+            }
+        } while (!listeners.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                  std::memory_order_acquire));
+        return true;
+    }
+
+    // 把回调压栈；如果已经完成则直接在当前线程执行
+    template <typename Callback>
+    void addListener(Callback&& callback) {
+        if (listeners.load(std::memory_order_acquire) == completedTag()) {
+            callback(result, value);
+            return;
+        }
+
+        auto node = new CallbackNode<std::decay_t<Callback> >(std::forward<Callback>(callback));
+        if (!push(node)) {
+            // 在压栈的过程中 promise 完成了
+            node->run(result, value);
+        }
+    }
+
+    // 抢到写入权的线程调用 setter 写入结果，然后唤醒等待者并执行回调
+    template <typename Setter>
+    bool complete(Setter&& setter) {
+        uint32_t expected = kPending;
+        if (!status.compare_exchange_strong(expected, kSetting, std::memory_order_acquire)) {
+            return false;
+        }
+        try {
+            setter(*this);
+        } catch (...) {
+            // 构造值时抛出了异常，promise 保持未完成
+            status.store(kPending, std::memory_order_release);
+            throw;
+        }
+
+        ListenerNode* node = listeners.exchange(completedTag(), std::memory_order_acq_rel);
+        status.store(kComplete, std::memory_order_release);
+        status.notify_all();
+
+        // 回调抛出异常时也要唤醒消费型 get，后面还没有执行的回调不再执行，只释放节点
+        struct Notified {
+            ~Notified() {
+                while (ordered) {
+                    ListenerNode* next = ordered->next;
+                    ordered->discard();
+                    ordered = next;
+                }
+                state->status.store(kNotified, std::memory_order_release);
+                state->status.notify_all();
+            }
+            InternalState* state;
+            ListenerNode* ordered;
+        } notified{this, nullptr};
+
+        // 栈是后进先出的，反转以后按照注册顺序执行回调
+        ListenerNode*& ordered = notified.ordered;
+        while (node) {
+            ListenerNode* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        while (ordered) {
+            ListenerNode* current = ordered;
+            ordered = ordered->next;
+            current->run(result, value);
+        }
+        return true;
+    }
+
+    std::atomic<uint32_t> status{kPending};
+    std::atomic<ListenerNode*> listeners{nullptr};
+    Result result{};
+    std::optional<Type> value;
 };
 
 template <typename Result, typename Type>
@@ -58,45 +273,147 @@ class Future {
    public:
     typedef std::function<void(Result, const Type&)> ListenerCallback;
 
-    Future& addListener(ListenerCallback callback) {
-        InternalState<Result, Type>* state = state_.get();
-        Lock lock(state->mutex);
-
-        //  如果promise已经设置好了值，那么直接执行回调
-        if (state->complete) {
-            lock.unlock();
-            callback(state->result, state->value);
-        } else {
-        // 否则还不到回调执行时机，把回调加入到列表里，等待promise
-            state->listeners.push_back(callback);
-        }
-
+    // 接受任意可调用对象，避免先包装成 std::function 再分配一次链表节点
+    template <typename Callback>
+    Future& addListener(Callback&& callback) {
+        typedef std::decay_t<Callback> F;
+        state_->addListener([callback = std::forward<Callback>(callback)](
+                                Result result, std::optional<Type>& value) mutable {
+            if constexpr (std::is_invocable_v<F&, Result, const std::optional<Type>&>) {
+                callback(result, std::as_const(value));
+            } else if (value) {
+                callback(result, std::as_const(*value));
+            } else {
+                callback(result, InternalState<Result, Type>::emptyValue());
+            }
+        });
         return *this;
     }
 
+    // 失败时 ValueResult 保持不变
     Result get(Type& ValueResult) {
         InternalState<Result, Type>* state = state_.get();
-        Lock lock(state->mutex);
+        state->wait();
+        if (state->value) {
+            ValueResult = *state->value;
+        }
+        return state->result;
+    }
 
-        if (!state->complete) {
-            // Wait for result
-            while (!state->complete) {
-                state->condition.wait(lock);
+    // 消费型 get：等回调都执行完，再把值移出来，失败时为空
+    std::pair<Result, std::optional<Type> > get() && {
+        InternalState<Result, Type>* state = state_.get();
+        state->wait(InternalState<Result, Type>::kNotified);
+        std::optional<Type> value = std::move(state->value);
+        state->value.reset();
+        return {state->result, std::move(value)};
+    }
+
+    bool isComplete() const { return state_->isComplete(); }
+
+    class Awaiter {
+       public:
+        explicit Awaiter(std::shared_ptr<InternalState<Result, Type> > state) : state_(std::move(state)) {}
+
+        bool await_ready() const { return state_->isComplete(); }
+
+        // 返回 false 表示在挂起之前已经完成，直接继续执行
+        bool await_suspend(std::coroutine_handle<> handle) {
+            node_.handle = handle;
+            return state_->push(&node_);
+        }
+
+        typedef std::conditional_t<std::is_default_constructible_v<Type>, std::pair<Result, Type>,
+                                   std::pair<Result, std::optional<Type> > >
+            AwaitResult;
+
+        AwaitResult await_resume() const {
+            std::optional<Type>& value = state_->value;
+            if constexpr (!std::is_default_constructible_v<Type>) {
+                return {state_->result, takeOrCopy(value)};
+            } else if (value) {
+                return {state_->result, takeOrCopy(*value)};
+            } else {
+                return {state_->result, Type()};
             }
         }
 
-        ValueResult = state->value;
-        return state->result;
+       private:
+        // node_ 在 state_ 之前声明：state_ 先析构，~InternalState 可能还会访问 node_
+        typename InternalState<Result, Type>::ResumeNode node_;
+        std::shared_ptr<InternalState<Result, Type> > state_;
+    };
+
+    Awaiter operator co_await() const { return Awaiter(state_); }
+
+    // func(const Type&) 的返回值 U 或者 Future<Result, U>，then 都返回 Future<Result, U>
+    template <typename F>
+    auto then(F&& func) {
+        return then(InlineExecutor(), std::forward<F>(func));
+    }
+
+    template <typename Executor, typename F>
+    auto then(Executor executor, F&& func) {
+        typedef std::invoke_result_t<std::decay_t<F>&, const Type&> Returned;
+        typedef typename UnwrapFuture<Returned>::type Next;
+        Promise<Result, Next> promise;
+        Future<Result, Next> next = promise.getFuture();
+        // 回调保存在 state_ 里，所以不能持有 state_，否则 promise 没有完成就被销毁时形成循环引用
+        state_->addListener([promise, executor, func = std::forward<F>(func)](
+                                Result result, std::optional<Type>& value) mutable {
+            if (result != Result()) {
+                promise.setFailed(result);
+                return;
+            }
+            if constexpr (std::is_same_v<Executor, InlineExecutor>) {
+                // 回调执行期间 value 一直有效
+                fulfill(promise, func, std::as_const(*value));
+            } else {
+                // 消费型 get 只等到回调执行完，所以在这里把值交给任务，而不是在任务里读 state_；
+                // 放在 shared_ptr 里，任务可以拷贝（例如放进 std::function）
+                auto v = std::make_shared<const Type>(takeOrCopy(*value));
+                executor.execute([promise, func = std::move(func), v]() mutable { fulfill(promise, func, *v); });
+            }
+        });
+        return next;
     }
 
    private:
+    // 只能移动的值被移出来，其他的拷贝
+    template <typename T>
+    static std::conditional_t<std::is_copy_constructible_v<Type>, const T&, T&&> takeOrCopy(T& v) {
+        return std::move(v);
+    }
+
+    // 用 func(value) 的结果完成 promise，func 返回 Future 时等它完成；
+    // 内层 future 可能还有别的持有者，所以和 co_await 一样只有只能移动的值被移出来
+    template <typename Next, typename Func>
+    static void fulfill(const Promise<Result, Next>& promise, Func& func, const Type& value) {
+        if constexpr (IsFuture<std::invoke_result_t<Func&, const Type&> >::value) {
+            func(value).state_->addListener([promise](Result r, std::optional<Next>& v) {
+                r == Result() ? promise.setValue(Future<Result, Next>::takeOrCopy(*v)) : promise.setFailed(r);
+            });
+        } else {
+            promise.setValue(func(value));
+        }
+    }
+
     typedef std::shared_ptr<InternalState<Result, Type> > InternalStatePtr;
     Future(InternalStatePtr state) : state_(state) {}
 
+    template <typename R, typename T>
+    friend class Future;
+
     std::shared_ptr<InternalState<Result, Type> > state_;
 
     template <typename U, typename V>
     friend class Promise;
+
+    // 和 then 一样在回调里取值，只能移动的值要移出来
+    template <typename R, typename T>
+    friend Future<R, std::vector<T> > whenAll(std::vector<Future<R, T> > futures);
+    template <typename R, typename T>
+    friend Future<R, std::pair<size_t, T> > whenAny(std::vector<Future<R, T> > futures);
 };
 
 template <typename Result, typename Type>
@@ -104,69 +421,28 @@ class Promise {
    public:
     Promise() : state_(std::make_shared<InternalState<Result, Type> >()) {}
 
-    bool setValue(const Type& value) const {
-        // 初始化错误码
-        static Result DEFAULT_RESULT;
-        InternalState<Result, Type>* state = state_.get();
-        //要更改state的数据，给state内部的锁加锁
-        Lock lock(state->mutex);
-
-        // 对promise多次使用SetValue是错误的
-        if (state->complete) {
-            return false;
-        }
-
-        state->value = value;
-        state->result = DEFAULT_RESULT;
-        state->complete = true;
-
-        //这里存在两种case
-        // promise.setvalue的时候，future还没有调用add_listener，那么这里什么也没有,cb在future.add_listener的时候直接执行
-        // promise.setvalue的时候，future已经设置好了所有回调，那么依次执行
-        decltype(state->listeners) listeners;
-        listeners.swap(state->listeners);
+    bool setValue(const Type& value) const { return emplace(value); }
 
-        lock.unlock();
-        // Promise设置值以后，依次调用listeners里的回调
-        for (auto& callback : listeners) {
-            callback(DEFAULT_RESULT, value);
-        }
+    bool setValue(Type&& value) const { return emplace(std::move(value)); }
 
-        state->condition.notify_all();
-        return true;
+    // 用 args 直接在共享状态里构造值
+    template <typename... Args>
+    bool emplace(Args&&... args) const {
+        // 初始化错误码
+        static Result DEFAULT_RESULT;
+        // 对promise多次使用SetValue是错误的，complete 会返回 false
+        return state_->complete([&](InternalState<Result, Type>& state) {
+            state.value.emplace(std::forward<Args>(args)...);
+            state.result = DEFAULT_RESULT;
+        });
     }
 
     bool setFailed(Result result) const {
-        // setFailed主要为了设置错误码
-        static Type DEFAULT_VALUE;
-        InternalState<Result, Type>* state = state_.get();
-        Lock lock(state->mutex);
-
-        if (state->complete) {
-            return false;
-        }
-
-        state->result = result;
-        state->complete = true;
-
-        decltype(state->listeners) listeners;
-        listeners.swap(state->listeners);
-
-        lock.unlock();
-
-        for (auto& callback : listeners) {
-            callback(result, DEFAULT_VALUE);
-        }
-
-        state->condition.notify_all();
-        return true;
+        // setFailed主要为了设置错误码，value 保持为空
+        return state_->complete([&](InternalState<Result, Type>& state) { state.result = result; });
     }
 
-    bool isComplete() const {
-        InternalState<Result, Type>* state = state_.get();
-        Lock lock(state->mutex);
-        return state->complete;
-    }
+    bool isComplete() const { return state_->isComplete(); }
 
     Future<Result, Type> getFuture() const { return Future<Result, Type>(state_); }
 
@@ -175,6 +451,60 @@ class Promise {
     std::shared_ptr<InternalState<Result, Type> > state_;
 };
 
+// 全部成功时按顺序返回所有值；任何一个失败则以第一个失败的错误码失败
+template <typename Result, typename Type>
+Future<Result, std::vector<Type> > whenAll(std::vector<Future<Result, Type> > futures) {
+    struct Shared {
+        explicit Shared(size_t n) : values(n), remaining(n) {}
+        Promise<Result, std::vector<Type> > promise;
+        std::vector<std::optional<Type> > values;
+        std::atomic<size_t> remaining;
+    };
+    auto shared = std::make_shared<Shared>(futures.size());
+    Future<Result, std::vector<Type> > all = shared->promise.getFuture();
+    if (futures.empty()) {
+        shared->promise.setValue({});
+        return all;
+    }
+    for (size_t i = 0; i < futures.size(); ++i) {
+        futures[i].state_->addListener([shared, i](Result result, std::optional<Type>& value) {
+            if (result != Result()) {
+                shared->promise.setFailed(result);
+                return;
+            }
+            shared->values[i].emplace(Future<Result, Type>::takeOrCopy(*value));
+            // 最后一个完成的负责设置结果，acq_rel 保证看到其他线程写入的值
+            if (shared->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::vector<Type> values;
+                values.reserve(shared->values.size());
+                for (auto& v : shared->values) {
+                    values.push_back(std::move(*v));
+                }
+                shared->promise.setValue(std::move(values));
+            }
+        });
+    }
+    return all;
+}
+
+// 第一个完成的 future 决定结果：成功时返回它的下标和值，失败时返回它的错误码
+template <typename Result, typename Type>
+Future<Result, std::pair<size_t, Type> > whenAny(std::vector<Future<Result, Type> > futures) {
+    // 没有 future 时永远不会完成，get 会一直等下去；也没有可以表示失败的通用错误码
+    if (futures.empty()) {
+        throw std::invalid_argument("whenAny: futures is empty");
+    }
+    Promise<Result, std::pair<size_t, Type> > promise;
+    for (size_t i = 0; i < futures.size(); ++i) {
+        // emplace 只有抢到写入权时才构造，所以没有胜出的 future 的值不会被移走
+        futures[i].state_->addListener([promise, i](Result result, std::optional<Type>& value) {
+            result == Result() ? promise.emplace(i, Future<Result, Type>::takeOrCopy(*value))
+                               : promise.setFailed(result);
+        });
+    }
+    return promise.getFuture();
+}
+
 } /* namespace pulsar */
 
-#endif /* LIB_FUTURE_H_ */
\ No newline at end of file
+#endif /* LIB_FUTURE_H_ */
@@ -0,0 +1,78 @@
+#ifndef LIB_INTEGER_PARSER_H_
+#define LIB_INTEGER_PARSER_H_
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "future.h"
+#include "thread_pool.h"
+
+namespace pulsar {
+
+enum class ErrorCode { kSuccess = 0, kInvalidFormat, kUserCallbackException };
+
+inline std::string strErrorCode(ErrorCode error) {
+  switch (error) {
+    case ErrorCode::kSuccess:
+      return "success";
+    case ErrorCode::kInvalidFormat:
+      return "invalid format";
+    case ErrorCode::kUserCallbackException:
+      return "exception from user's callback";
+  }
+  return "unknown error";  // 永远不会到达这里，仅仅是为了关闭编译警告
+}
+
+// 解析在 executor 上执行（默认是线程池），不再为每次调用创建并 detach 一个线程
+// 每次调用使用新的 promise，input 按值拷贝进任务，调用者不需要保证 input 的生命周期
+template <typename Executor>
+class BasicIntegerParser {
+ public:
+  explicit BasicIntegerParser(Executor executor) : executor_(std::move(executor)) {}
+
+  // 异步 API，用户提供回调，注意，回调的参数2是 int 而非 const int&
+  // 回调可以为空，例如在协程里直接 co_await 返回的 future
+  Future<ErrorCode, int> parseAsync(
+      std::string input, std::function<void(ErrorCode, int)> callback = nullptr) {
+    Promise<ErrorCode, int> promise;
+    auto future = promise.getFuture();
+    // 先注册回调再提交任务
+    // 间接调用回调，并处理用户提供的回调可能抛出的异常
+    if (callback) {
+      future.addListener([callback](ErrorCode code, const int& result) {
+        try {
+          callback(code, result);
+        } catch (const std::exception& e) {
+          std::cerr << "[ERROR] User's callback throws: " << e.what()
+                    << std::endl;
+        }
+      });
+    }
+    executor_.execute([promise, input = std::move(input)] {
+      try {
+        int number = std::stoi(input);
+        promise.setValue(number);
+      } catch (...) {
+        promise.setFailed(ErrorCode::kInvalidFormat);
+      }
+    });
+    return future;
+  }
+
+  // 同步 API，返回错误码，传入引用保存处理结果
+  // 错误码取自 get 的返回值：回调可能在 get 返回之后才在其他线程执行完
+  ErrorCode parse(const std::string& input, int& result) {
+    return parseAsync(input).get(result);
+  }
+
+ private:
+  Executor executor_;
+};
+
+typedef BasicIntegerParser<ThreadPool::Executor> IntegerParser;
+
+} /* namespace pulsar */
+
+#endif /* LIB_INTEGER_PARSER_H_ */
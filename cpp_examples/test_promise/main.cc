@@ -1,67 +1,39 @@
 
 #include "future.h"
-#include <thread>
+#include "integer_parser.h"
+#include "task.h"
+#include "thread_pool.h"
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace pulsar;
-enum class ErrorCode { kSuccess = 0, kInvalidFormat, kUserCallbackException };
-
-inline std::string strErrorCode(ErrorCode error) {
-  switch (error) {
-    case ErrorCode::kSuccess:
-      return "success";
-    case ErrorCode::kInvalidFormat:
-      return "invalid format";
-    case ErrorCode::kUserCallbackException:
-      return "exception from user's callback";
-  }
-  return "unknown error";  // 永远不会到达这里，仅仅是为了关闭编译警告
+
+// 协程版本：按顺序等待异步解析的结果，不需要嵌套回调
+Task<int> parseOne(IntegerParser& parser, std::string input)
+{
+    auto [err, value] = co_await parser.parseAsync(std::move(input));
+    if(err != ErrorCode::kSuccess)
+    {
+        throw std::runtime_error(strErrorCode(err));
+    }
+    co_return value;
 }
 
-class IntegerParser {
- public:
-  // 异步 API，用户提供回调，注意，回调的参数2是 int 而非 const int&
-  Future<ErrorCode, int> parseAsync(
-      const std::string& input, std::function<void(ErrorCode, int)> callback) {
-    std::thread t([&input, this] {
-      try {
-        int number = std::stoi(input);
-        promise_.setValue(number);
-      } catch (...) {
-        promise_.setFailed(ErrorCode::kInvalidFormat);
-      }
-    });
-    t.detach();
-    // 间接调用回调，并处理用户提供的回调可能抛出的异常
-    return promise_.getFuture().addListener(
-        [callback](ErrorCode code, const int& result) {
-          try {
-            callback(code, result);
-          } catch (const std::exception& e) {
-            std::cerr << "[ERROR] User's callback throws: " << e.what()
-                      << std::endl;
-          }
-        });
-  }
-
-  // 同步 API，返回错误码，传入引用保存处理结果
-  ErrorCode parse(const std::string& input, int& result) {
-    auto parse_error = ErrorCode::kSuccess;
-    auto fut = parseAsync(input, [&parse_error](ErrorCode error, const int&) {
-      parse_error = error;
-    });
-    fut.get(result);
-    return parse_error;
-  }
-
- private:
-  Promise<ErrorCode, int> promise_;
-};
+Task<int> parseSum(IntegerParser& parser, std::string a, std::string b)
+{
+    int x = co_await parseOne(parser, std::move(a));
+    int y = co_await parseOne(parser, std::move(b));
+    co_return x + y;
+}
 
 int main()
 {
-    IntegerParser parser;
+    // 解析任务和回调都在线程池里执行
+    ThreadPool pool(4);
+    IntegerParser parser(pool.executor());
 
     std::function<void(ErrorCode,int)> parse_cb = [](ErrorCode err,int input)
     {
@@ -76,7 +48,151 @@ int main()
     auto future = parser.parseAsync(s, parse_cb);
     int res = 0;
     future.get(res);
-    // parser.parse("123123", res);
     std::cout << "res: " << res << std::endl;
+    std::cout << "parse(\"abc\"): " << strErrorCode(parser.parse("abc", res)) << std::endl;
+
+    // then/whenAll/whenAny 组合多个异步阶段，不需要阻塞等待中间结果
+    {
+        Promise<ErrorCode, std::string> text;
+        auto length = text.getFuture()
+                          .then([](const std::string& s) { return int(s.size()); })
+                          .then(pool.executor(), [](const int& n) { return n * 2; });
+        text.setValue("hello");
+        int doubled = 0;
+        length.get(doubled);
+        std::cout << "then: " << doubled << std::endl;
+
+        Promise<ErrorCode, int> bad;
+        auto skipped = bad.getFuture().then([](const int& n) { return n + 1; });
+        bad.setFailed(ErrorCode::kInvalidFormat);
+        int unused = 0;
+        std::cout << "then after failure: " << strErrorCode(skipped.get(unused)) << std::endl;
+
+        std::vector<Promise<ErrorCode, int> > promises(3);
+        std::vector<Future<ErrorCode, int> > futures;
+        for (auto& p : promises) futures.push_back(p.getFuture());
+        auto all = whenAll(futures);
+        auto any = whenAny(futures);
+        promises[2].setValue(30);
+        promises[0].setValue(10);
+        promises[1].setValue(20);
+        std::vector<int> values;
+        all.get(values);
+        std::pair<size_t, int> first;
+        any.get(first);
+        std::cout << "whenAll: " << values[0] << " " << values[1] << " " << values[2]
+                  << ", whenAny: #" << first.first << " = " << first.second << std::endl;
+
+        // func 返回 Future 时展开成内层 future 的值
+        Promise<ErrorCode, int> outer;
+        Promise<ErrorCode, std::string> inner;
+        auto unwrapped = outer.getFuture().then(pool.executor(), [&](const int& n) {
+            return inner.getFuture().then([n](const std::string& s) { return s + std::to_string(n); });
+        });
+        outer.setValue(7);
+        inner.setValue("unwrapped ");
+        std::string text_value;
+        unwrapped.get(text_value);
+        std::cout << "then -> future: " << text_value << std::endl;
+
+        // 内层 future 的值是拷贝过来的，它的其他持有者还可以 get
+        Promise<ErrorCode, std::string> shared_text;
+        auto shared_future = shared_text.getFuture();
+        auto copied = outer.getFuture().then([&](const int&) { return shared_future; });
+        shared_text.setValue("still here");
+        copied.get(text_value);
+        std::string kept;
+        shared_future.get(kept);
+        std::cout << "shared inner future: " << text_value << " / " << kept << std::endl;
+
+        // 任务晚于消费型 get 执行：值在回调里已经交给了任务
+        struct DeferredExecutor {
+            std::shared_ptr<std::vector<std::function<void()> > > tasks =
+                std::make_shared<std::vector<std::function<void()> > >();
+            void execute(std::function<void()> task) const { tasks->push_back(std::move(task)); }
+        } deferred;
+        Promise<ErrorCode, std::string> long_text;
+        auto consumed = long_text.getFuture();
+        auto deferred_size = consumed.then(deferred, [](const std::string& s) { return int(s.size()); });
+        long_text.setValue(std::string(100, 'x'));
+        auto taken = std::move(consumed).get();
+        for (auto& task : *deferred.tasks) task();
+        int size = 0;
+        deferred_size.get(size);
+        std::cout << "then after consuming get: " << size << " / " << taken.second->size() << std::endl;
+
+        try {
+            whenAny(std::vector<Future<ErrorCode, int> >());
+        } catch (const std::invalid_argument& e) {
+            std::cout << "whenAny(empty): " << e.what() << std::endl;
+        }
+    }
+
+    // promise 没有完成就被销毁：then 的回调被释放，不会和共享状态形成循环引用
+    {
+        auto token = std::make_shared<int>(0);
+        {
+            Promise<ErrorCode, int> dropped;
+            dropped.getFuture().then([token](const int& n) { return n; });
+        }
+        std::cout << "dropped promise released: " << (token.use_count() == 1) << std::endl;
+    }
+
+    // 只能移动的值：setValue(Type&&) / emplace 移动进共享状态，std::move(future).get() 再移出来
+    {
+        Promise<ErrorCode, std::unique_ptr<std::string> > owned;
+        auto future = owned.getFuture();
+        owned.setValue(std::make_unique<std::string>("moved"));
+        auto [err, value] = std::move(future).get();
+        std::cout << "move-only: " << **value << std::endl;
+
+        // 只能移动的值被 whenAll / whenAny 移走，每个 future 只能交给一个
+        std::vector<Promise<ErrorCode, std::unique_ptr<int> > > parts(4);
+        std::vector<Future<ErrorCode, std::unique_ptr<int> > > part_futures;
+        for (auto& p : parts) part_futures.push_back(p.getFuture());
+        auto joined = whenAll(std::vector<Future<ErrorCode, std::unique_ptr<int> > >(
+            part_futures.begin(), part_futures.begin() + 2));
+        auto fastest = whenAny(std::vector<Future<ErrorCode, std::unique_ptr<int> > >(
+            part_futures.begin() + 2, part_futures.end()));
+        for (size_t i = parts.size(); i-- > 0;) parts[i].setValue(std::make_unique<int>(int(i)));
+        auto [all_err, owned_parts] = std::move(joined).get();
+        auto [any_err, winner] = std::move(fastest).get();
+        std::cout << "move-only whenAll: " << *(*owned_parts)[0] << " " << *(*owned_parts)[1]
+                  << ", whenAny: #" << winner->first << " = " << *winner->second << std::endl;
+
+        Promise<ErrorCode, std::vector<int> > buffer;
+        buffer.emplace(1000, 7);
+        std::vector<int> data = *std::move(buffer.getFuture()).get().second;
+        std::cout << "emplace: " << data.size() << " x " << data[0] << std::endl;
+    }
+
+    // co_await：任务结束时的错误码是协程抛出的异常
+    {
+        int sum = 0;
+        parseSum(parser, "40", "2").start().get(sum);
+        std::cout << "co_await: " << sum << std::endl;
+
+        std::exception_ptr error = parseSum(parser, "40", "x").start().get(sum);
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            std::cout << "co_await failure: " << e.what() << std::endl;
+        }
+    }
+
+    // 回调抛出异常：异常传给 setValue 的调用者，后面的回调不再执行，节点被释放
+    {
+        Promise<ErrorCode, int> p;
+        auto token = std::make_shared<int>(0);
+        p.getFuture()
+            .addListener([](ErrorCode, const int&) { throw std::runtime_error("listener"); })
+            .addListener([token](ErrorCode, const int&) { ++*token; });
+        try {
+            p.setValue(1);
+        } catch (const std::exception& e) {
+            std::cout << "throwing listener: " << e.what() << ", skipped " << (*token == 0)
+                      << ", released " << (token.use_count() == 1) << std::endl;
+        }
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,361 @@
+// future.h（无锁）和 future_mutex.h（互斥锁）的对比测试
+//   fan-out:   4 个线程同时给同一批 future 添加回调，另一个线程同时 setValue
+//   completed: 结果已经设置好以后 addListener + get（快速路径），单线程
+//   handoff:   生产者逐个 setValue，消费者逐个阻塞 get
+//   chain:     深度为 N 的异步流水线：then 串联 N 个 continuation，
+//              对比每一级一个线程、阻塞 get 上一级结果再 setValue 的写法
+//   parse:     IntegerParser 异步解析短字符串，线程池对比每个任务一个线程
+//   await:     单线程按顺序等待 N 个未完成的 future：std::function 回调、模板回调、co_await；
+//              程序结束时另外打印每个 future 的分配次数（替换了全局 operator new）
+//   payload:   传递 std::vector<char>：setValue(const&) + get(Type&) 拷贝两次，
+//              对比 setValue(Type&&) + std::move(future).get() 移动
+// 使用 ../benchmark 的 picobench runner，例如 --samples=5 --json=out.json
+
+#define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#define BENCH_RUNNER_IMPLEMENT_MAIN
+#include "bench_runner.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "future.h"
+#include "future_mutex.h"
+#include "integer_parser.h"
+#include "task.h"
+#include "thread_pool.h"
+
+enum class BenchResult { kOk, kFailed };
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+constexpr int kListenerThreads = 4;
+
+template <template <typename, typename> class PromiseT>
+void FanOut(picobench::state& s) {
+    using Promise = PromiseT<BenchResult, int>;
+    std::vector<Promise> promises(s.iterations());
+    std::atomic<int64_t> sum{0};
+    {
+        bench::perf_scope scope(s);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kListenerThreads; ++t) {
+            threads.emplace_back([&] {
+                for (auto& p : promises) {
+                    p.getFuture().addListener([&sum](BenchResult, const int& v) {
+                        sum.fetch_add(v, std::memory_order_relaxed);
+                    });
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < promises.size(); ++i) promises[i].setValue(int(i));
+        });
+        for (auto& t : threads) t.join();
+    }
+    s.set_result(sum.load());
+}
+
+template <template <typename, typename> class PromiseT>
+void Completed(picobench::state& s) {
+    using Promise = PromiseT<BenchResult, int>;
+    std::vector<Promise> promises(s.iterations());
+    for (size_t i = 0; i < promises.size(); ++i) promises[i].setValue(int(i));
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        for (auto& p : promises) {
+            auto future = p.getFuture();
+            future.addListener([&sum](BenchResult, const int& v) { sum += v; });
+            int v = 0;
+            future.get(v);
+            sum += v;
+        }
+    }
+    s.set_result(sum);
+}
+
+template <template <typename, typename> class PromiseT>
+void Handoff(picobench::state& s) {
+    using Promise = PromiseT<BenchResult, int>;
+    std::vector<Promise> promises(s.iterations());
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        std::thread producer([&] {
+            for (size_t i = 0; i < promises.size(); ++i) promises[i].setValue(int(i));
+        });
+        for (auto& p : promises) {
+            int v = 0;
+            p.getFuture().get(v);
+            sum += v;
+        }
+        producer.join();
+    }
+    s.set_result(sum);
+}
+
+void fan_out_mutex(picobench::state& s) { FanOut<pulsar::locked::Promise>(s); }
+void fan_out_lock_free(picobench::state& s) { FanOut<pulsar::Promise>(s); }
+void completed_mutex(picobench::state& s) { Completed<pulsar::locked::Promise>(s); }
+void completed_lock_free(picobench::state& s) { Completed<pulsar::Promise>(s); }
+void handoff_mutex(picobench::state& s) { Handoff<pulsar::locked::Promise>(s); }
+void handoff_lock_free(picobench::state& s) { Handoff<pulsar::Promise>(s); }
+
+PICOBENCH_SUITE("fan-out");
+PICOBENCH(fan_out_mutex).iterations({16384, 131072}).baseline();
+PICOBENCH(fan_out_lock_free).iterations({16384, 131072});
+
+PICOBENCH_SUITE("completed");
+PICOBENCH(completed_mutex).iterations({16384, 131072}).baseline();
+PICOBENCH(completed_lock_free).iterations({16384, 131072});
+
+PICOBENCH_SUITE("handoff");
+PICOBENCH(handoff_mutex).iterations({16384, 131072}).baseline();
+PICOBENCH(handoff_lock_free).iterations({16384, 131072});
+
+void chain_nested_get(picobench::state& s) {
+    const int depth = s.iterations();
+    std::vector<pulsar::Promise<BenchResult, int> > stages(depth + 1);
+    int v = 0;
+    {
+        bench::perf_scope scope(s);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < depth; ++i) {
+            threads.emplace_back([&stages, i] {
+                int x = 0;
+                stages[i].getFuture().get(x);
+                stages[i + 1].setValue(x + 1);
+            });
+        }
+        stages[0].setValue(0);
+        stages[depth].getFuture().get(v);
+        for (auto& t : threads) t.join();
+    }
+    s.set_result(v);
+}
+
+void chain_then(picobench::state& s) {
+    const int depth = s.iterations();
+    int v = 0;
+    {
+        bench::perf_scope scope(s);
+        pulsar::Promise<BenchResult, int> root;
+        auto future = root.getFuture();
+        for (int i = 0; i < depth; ++i) future = future.then([](const int& x) { return x + 1; });
+        std::thread producer([&] { root.setValue(0); });
+        future.get(v);
+        producer.join();
+    }
+    s.set_result(v);
+}
+
+PICOBENCH_SUITE("chain");
+PICOBENCH(chain_nested_get).iterations({16, 256}).baseline();
+PICOBENCH(chain_then).iterations({16, 256});
+
+// 原来 parseAsync 的做法：每个任务创建一个线程并 detach
+// （任务只持有自己的 promise 和 input 拷贝，不引用测试里的数据）
+struct ThreadPerTaskExecutor {
+    template <typename F>
+    void execute(F&& task) const {
+        std::thread(std::forward<F>(task)).detach();
+    }
+};
+
+template <typename Parser>
+int64_t ParseAll(Parser& parser, int n) {
+    std::vector<pulsar::Future<pulsar::ErrorCode, int> > futures;
+    futures.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        futures.push_back(parser.parseAsync(std::to_string(i), [](pulsar::ErrorCode, int) {}));
+    }
+    int64_t sum = 0;
+    for (auto& f : futures) {
+        int v = 0;
+        f.get(v);
+        sum += v;
+    }
+    return sum;
+}
+
+void parse_thread_per_task(picobench::state& s) {
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        pulsar::BasicIntegerParser<ThreadPerTaskExecutor> parser(ThreadPerTaskExecutor{});
+        sum = ParseAll(parser, s.iterations());
+    }
+    s.set_result(sum);
+}
+
+void parse_thread_pool(picobench::state& s) {
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        pulsar::ThreadPool pool;
+        pulsar::IntegerParser parser(pool.executor());
+        sum = ParseAll(parser, s.iterations());
+    }
+    s.set_result(sum);
+}
+
+PICOBENCH_SUITE("parse");
+PICOBENCH(parse_thread_per_task).iterations({16384, 1048576}).baseline();
+PICOBENCH(parse_thread_pool).iterations({16384, 1048576});
+
+// 每个 future 的分配次数（每个 sample 都一样），程序结束时打印
+struct AllocationReport {
+    std::map<std::string, double> rows;
+    ~AllocationReport() {
+        if (rows.empty()) return;
+        std::printf("## await (allocations per future):\n\n");
+        for (const auto& row : rows) std::printf(" %-34s %6.3f\n", row.first.c_str(), row.second);
+    }
+} g_allocationReport;
+
+struct AwaitLoop {
+    std::vector<pulsar::Future<BenchResult, int> > futures;
+    int64_t sum = 0;
+};
+
+// 嵌套回调的写法：每一步在回调里注册下一步，状态通过 shared_ptr 传递
+void ListenerStep(std::shared_ptr<AwaitLoop> loop, size_t i) {
+    if (i == loop->futures.size()) return;
+    pulsar::Future<BenchResult, int>::ListenerCallback callback = [loop, i](BenchResult, const int& v) {
+        loop->sum += v;
+        ListenerStep(loop, i + 1);
+    };
+    loop->futures[i].addListener(std::move(callback));
+}
+
+void LambdaStep(std::shared_ptr<AwaitLoop> loop, size_t i) {
+    if (i == loop->futures.size()) return;
+    loop->futures[i].addListener([loop, i](BenchResult, const int& v) {
+        loop->sum += v;
+        LambdaStep(loop, i + 1);
+    });
+}
+
+pulsar::Task<int64_t> AwaitAll(std::shared_ptr<AwaitLoop> loop) {
+    int64_t sum = 0;
+    for (auto& f : loop->futures) {
+        auto [result, v] = co_await f;
+        sum += v;
+    }
+    co_return sum;
+}
+
+// 在同一个线程里逐个 setValue，每次 setValue 恢复等待者，等待者再等待下一个
+template <typename Start>
+void AwaitBench(picobench::state& s, const char* name, Start start) {
+    std::vector<pulsar::Promise<BenchResult, int> > promises(s.iterations());
+    auto loop = std::make_shared<AwaitLoop>();
+    for (auto& p : promises) loop->futures.push_back(p.getFuture());
+    int64_t sum = 0;
+    size_t allocations = 0;
+    {
+        bench::perf_scope scope(s);
+        size_t before = g_allocations.load(std::memory_order_relaxed);
+        auto finish = start(loop);
+        for (size_t i = 0; i < promises.size(); ++i) promises[i].setValue(int(i));
+        sum = finish();
+        allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    }
+    g_allocationReport.rows[std::string(name) + " @" + std::to_string(s.iterations())] =
+        double(allocations) / s.iterations();
+    s.set_result(sum);
+}
+
+void await_std_function(picobench::state& s) {
+    AwaitBench(s, "await_std_function", [](std::shared_ptr<AwaitLoop> loop) {
+        ListenerStep(loop, 0);
+        return [loop] { return loop->sum; };
+    });
+}
+
+void await_lambda(picobench::state& s) {
+    AwaitBench(s, "await_lambda", [](std::shared_ptr<AwaitLoop> loop) {
+        LambdaStep(loop, 0);
+        return [loop] { return loop->sum; };
+    });
+}
+
+void await_coroutine(picobench::state& s) {
+    AwaitBench(s, "await_coroutine", [](std::shared_ptr<AwaitLoop> loop) {
+        auto future = AwaitAll(loop).start();
+        return [future]() mutable {
+            int64_t sum = 0;
+            future.get(sum);
+            return sum;
+        };
+    });
+}
+
+PICOBENCH_SUITE("await");
+PICOBENCH(await_std_function).iterations({1024, 65536}).baseline();
+PICOBENCH(await_lambda).iterations({1024, 65536});
+PICOBENCH(await_coroutine).iterations({1024, 65536});
+
+template <size_t Bytes>
+void PayloadCopy(picobench::state& s) {
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        for (auto i : s) {
+            std::vector<char> payload(Bytes, char(i));
+            pulsar::Promise<BenchResult, std::vector<char> > promise;
+            auto future = promise.getFuture();
+            promise.setValue(payload);
+            std::vector<char> out;
+            future.get(out);
+            sum += out.back();
+        }
+    }
+    s.set_result(sum);
+}
+
+template <size_t Bytes>
+void PayloadMove(picobench::state& s) {
+    int64_t sum = 0;
+    {
+        bench::perf_scope scope(s);
+        for (auto i : s) {
+            std::vector<char> payload(Bytes, char(i));
+            pulsar::Promise<BenchResult, std::vector<char> > promise;
+            auto future = promise.getFuture();
+            promise.setValue(std::move(payload));
+            std::vector<char> out = *std::move(future).get().second;
+            sum += out.back();
+        }
+    }
+    s.set_result(sum);
+}
+
+void payload_copy_256(picobench::state& s) { PayloadCopy<256>(s); }
+void payload_move_256(picobench::state& s) { PayloadMove<256>(s); }
+void payload_copy_64k(picobench::state& s) { PayloadCopy<65536>(s); }
+void payload_move_64k(picobench::state& s) { PayloadMove<65536>(s); }
+
+PICOBENCH_SUITE("payload 256B");
+PICOBENCH(payload_copy_256).iterations({1024, 16384}).baseline();
+PICOBENCH(payload_move_256).iterations({1024, 16384});
+
+PICOBENCH_SUITE("payload 64KB");
+PICOBENCH(payload_copy_64k).iterations({1024, 16384}).baseline();
+PICOBENCH(payload_move_64k).iterations({1024, 16384});
@@ -0,0 +1,133 @@
+#ifndef LIB_TASK_H_
+#define LIB_TASK_H_
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "future.h"
+
+// 轻量的协程任务类型 Task<Type>，用来代替层层嵌套的回调
+// 1. 惰性启动：创建时不执行，被 co_await 时才开始执行；结束时用对称转移直接恢复等待者，
+//    不经过 future 的共享状态，一个任务只有协程帧这一次分配
+// 2. 普通函数里用 start() 启动，返回 Future<std::exception_ptr, Type>：
+//    成功时错误码是空的 exception_ptr，协程里抛出的异常作为错误码
+// 3. 协程里 co_await Future 得到 std::pair<Result, Type>，见 future.h
+// Type 不能是 void（和 Future 一样）
+
+namespace pulsar {
+
+template <typename Type>
+class Task {
+   public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+            promise_type& p = handle.promise();
+            if (p.continuation) {
+                return p.continuation;
+            }
+            // start() 启动的任务没有等待者：先把结果移出来并销毁协程帧，再完成 promise，
+            // 这样 get 返回以后不会再有线程访问协程帧
+            Promise<std::exception_ptr, Type> promise = std::move(*p.detached);
+            std::exception_ptr error = p.error;
+            std::optional<Type> value = std::move(p.value);
+            handle.destroy();
+            if (error) {
+                promise.setFailed(error);
+            } else {
+                promise.setValue(std::move(*value));
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U&& v) {
+            value.emplace(std::forward<U>(v));
+        }
+
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // co_await 这个任务的协程
+        std::coroutine_handle<> continuation;
+        // start() 启动时才有
+        std::optional<Promise<std::exception_ptr, Type> > detached;
+        std::optional<Type> value;
+        std::exception_ptr error;
+    };
+
+    class Awaiter {
+       public:
+        explicit Awaiter(Handle handle) : handle_(handle) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle_.promise().continuation = awaiting;
+            return handle_;
+        }
+
+        Type await_resume() {
+            promise_type& p = handle_.promise();
+            if (p.error) {
+                std::rethrow_exception(p.error);
+            }
+            return std::move(*p.value);
+        }
+
+       private:
+        Handle handle_;
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // 在当前线程开始执行，直到第一次挂起；任务结束后协程帧自己销毁
+    Future<std::exception_ptr, Type> start() && {
+        Handle handle = std::exchange(handle_, {});
+        handle.promise().detached.emplace();
+        Future<std::exception_ptr, Type> future = handle.promise().detached->getFuture();
+        handle.resume();
+        return future;
+    }
+
+    // 每个任务只能 co_await 一次
+    Awaiter operator co_await() const noexcept { return Awaiter(handle_); }
+
+   private:
+    explicit Task(Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+};
+
+} /* namespace pulsar */
+
+#endif /* LIB_TASK_H_ */
@@ -0,0 +1,164 @@
+#ifndef LIB_THREAD_POOL_H_
+#define LIB_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 工作窃取线程池，用来代替每个异步调用 detach 一个 std::thread
+// 1. 每个工作线程有自己的任务队列：自己从队尾取（后进先出，缓存更热），
+//    空闲的线程从别人的队头偷（先进先出，偷走最老的任务）
+// 2. 工作线程里 post 的任务（例如 then 的 continuation）放进自己的队列，
+//    外部线程 post 的任务轮流放进各个队列
+// 3. 没有任务时线程睡在条件变量上，只有存在睡眠线程时 post 才需要加锁唤醒
+// 析构时会先执行完所有已经提交的任务
+
+namespace pulsar {
+
+class ThreadPool {
+   public:
+    typedef std::function<void()> Task;
+
+    // 可以拷贝的句柄，满足 Future::then(executor, func) 对 executor 的要求
+    struct Executor {
+        ThreadPool* pool;
+        template <typename F>
+        void execute(F&& task) const {
+            pool->post(std::forward<F>(task));
+        }
+    };
+
+    explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency()) {
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_ = true;
+        }
+        sleepCondition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void post(Task task) {
+        size_t index;
+        if (currentPool() == this) {
+            index = currentIndex();
+        } else {
+            index = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        }
+        // 先计数再入队：任务被取走时 pending_ 已经加过，fetch_sub 不会减到 0 以下；
+        // 和 run() 里 sleepers_ / pending_ 的顺序配对，保证不会丢失唤醒
+        pending_.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            sleepCondition_.notify_one();
+        }
+    }
+
+    Executor executor() { return Executor{this}; }
+
+    size_t size() const { return workers_.size(); }
+
+   private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static ThreadPool*& currentPool() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentIndex() {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    bool popLocal(size_t index, Task& task) {
+        Queue& q = *queues_[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) {
+            return false;
+        }
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t index, Task& task) {
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            Queue& q = *queues_[(index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+        Task task;
+        while (true) {
+            if (popLocal(index, task) || steal(index, task)) {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            while (pending_.load(std::memory_order_seq_cst) == 0 && !stop_) {
+                sleepCondition_.wait(lock);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if (stop_ && pending_.load(std::memory_order_seq_cst) == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> nextQueue_{0};
+    // 已提交但还没有被取走的任务数
+    std::atomic<size_t> pending_{0};
+    std::atomic<int> sleepers_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCondition_;
+    bool stop_ = false;
+};
+
+} /* namespace pulsar */
+
+#endif /* LIB_THREAD_POOL_H_ */